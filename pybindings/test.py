@@ -1,16 +1,128 @@
-from tms9918 import Tms9918
-from PIL import Image
+import sys
 
-t=Tms9918()
+from tms9918 import Tms9918, Tms9918Array, FRAME_BYTES
 
 d=open("image.bin","rb").read()
 vram=d[:16*1024]
 regs=d[16*1024:]
 
 
-t.setRegs(list(regs))
-t.setVram(0,list(vram))
+def loaded():
+  t=Tms9918()
+  t.setRegs(regs)
+  t.setVram(0,vram)
+  return t
 
 
-img = Image.frombytes('RGB', (256, 192), bytes(t.getScreen()))
-img.show()
+def indexed(t):
+  frame=bytearray(FRAME_BYTES)
+  t.renderIndexed(frame)
+  return frame
+
+
+def raises(exception, fn, *args):
+  try:
+    fn(*args)
+  except exception:
+    return
+  raise AssertionError("expected %s" % exception.__name__)
+
+
+def testWriteDataBytes():
+  t=Tms9918()
+  t.writeAddrBytes(bytes([0x00, 0x40]))   # write address 0
+  t.writeDataBytes(bytes(range(256)))
+  out=bytearray(256)
+  t.getVramInto(0,out)
+  assert out==bytes(range(256))
+
+  t.writeAddrBytes(bytes([0x10, 0x00]))   # read address 0x10
+  out=bytearray(16)
+  t.readDataInto(out)
+  assert out==bytes(range(0x10, 0x20))
+
+
+def testSetVram():
+  t=Tms9918()
+  t.setVram(0x100, bytes([1, 2]))   # through the port. address follows the data
+  t.writeDataBytes(bytes([3]))
+  t.writeVram(0x200, bytes([4]))    # direct. address pointer unchanged
+  t.writeDataBytes(bytes([5]))
+  out=bytearray(4)
+  t.getVramInto(0x100,out)
+  assert out==bytes([1, 2, 3, 5])
+  t.getVramInto(0x200,out)
+  assert out[0]==4
+
+
+def testRunFrames():
+  t=loaded()
+  expected=indexed(t)
+  frames=bytearray(FRAME_BYTES*3 + 5)   # the partial frame is left alone
+  assert t.runFrames(frames)==3
+  for i in range(3):
+    assert frames[i*FRAME_BYTES:(i+1)*FRAME_BYTES]==expected
+  assert frames[3*FRAME_BYTES:]==bytes(5)
+  raises(ValueError, t.runFrames, bytearray(FRAME_BYTES - 1))
+
+
+def testFrames():
+  t=Tms9918()
+  t.setReg(1, 0x80)   # blanked. the frame is the backdrop color
+  t.setReg(7, 4)
+  out=bytearray(FRAME_BYTES*2)
+  count=0
+  for frame in t.frames(out):
+    assert len(frame)==FRAME_BYTES
+    assert bytes(frame)==bytes([count + 4])*FRAME_BYTES
+    count+=1
+    t.setReg(7, count + 4)   # drive the ports between frames
+  assert count==2
+
+
+def testArray():
+  arr=Tms9918Array(3)
+  assert len(arr)==3
+  raises(IndexError, arr.__getitem__, 3)
+
+  arr.setRegs(regs)
+  arr.setVram(0,vram)
+  expected=indexed(loaded())
+  out=bytearray(FRAME_BYTES*3)
+  arr.render(out)
+  for i in range(3):
+    assert out[i*FRAME_BYTES:(i+1)*FRAME_BYTES]==expected
+
+  out=bytearray(FRAME_BYTES*3)
+  arr.runFrame(out)
+  for i in range(3):
+    assert out[i*FRAME_BYTES:(i+1)*FRAME_BYTES]==expected
+  raises(ValueError, arr.render, bytearray(FRAME_BYTES*2))
+
+  # instance i gets the i'th share of each buffer
+  arr.writeAddrBytes(bytes([0x00, 0x40]*3))
+  arr.writeDataBytes(bytes([1, 2, 3]))
+  for i in range(3):
+    out=bytearray(1)
+    arr[i].getVramInto(0,out)
+    assert out[0]==i + 1
+  status=bytearray(3)
+  arr.readStatusInto(status)
+  raises(ValueError, arr.writeDataBytes, bytes(4))
+
+
+def testMisaligned():
+  t=loaded()
+  out=bytearray(FRAME_BYTES*4 + 1)
+  raises(ValueError, t.renderRgba, memoryview(out)[1:])
+  t.renderRgba(memoryview(out)[:FRAME_BYTES*4])
+
+
+for test in [testWriteDataBytes, testSetVram, testRunFrames, testFrames, testArray, testMisaligned]:
+  test()
+  print("%s ok" % test.__name__)
+
+if "--show" in sys.argv:
+  from PIL import Image
+  img = Image.frombytes('RGB', (256, 192), bytes(loaded().getScreen()))
+  img.show()
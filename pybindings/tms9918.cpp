@@ -1,74 +1,357 @@
-#include "vrEmuTms9918Util.h"
+#include "vrEmuTms9918.hpp"
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
-#include <pybind11/stl_bind.h>
 #include <stdint.h>
+#include <utility>
 #include <vector>
 
-class Tms9918 {
+namespace py = pybind11;
+
+// a contiguous byte view of a python buffer (bytes, bytearray, memoryview,
+// numpy array, ...). keeps the buffer request alive while in use
+class ByteBuffer {
 public:
-  Tms9918();
-  ~Tms9918();
-  void setReg(uint8_t reg, uint8_t val);
-  void setRegs(const std::vector<uint8_t> &val);
-  void setVram(uint16_t addr, const std::vector<uint8_t> &data);
-  std::vector<uint8_t> getScreen();
+  ByteBuffer(const py::buffer &buffer, bool writable)
+      : info(buffer.request(writable)) {
+    py::ssize_t expected = info.itemsize;
+    for (py::ssize_t i = info.ndim - 1; i >= 0; --i) {
+      if (info.shape[i] > 1 && info.strides[i] != expected) {
+        throw py::value_error("buffer must be C contiguous");
+      }
+      expected *= info.shape[i];
+    }
+  }
+
+  // wider pixel formats are accessed in place, so the buffer must be
+  // aligned for them (eg. not a memoryview sliced at an odd offset)
+  template <typename T> vrEmu::Span<T> span() const {
+    if (reinterpret_cast<uintptr_t>(info.ptr) % alignof(T) != 0) {
+      throw py::value_error("buffer is not aligned for the pixel format");
+    }
+    return vrEmu::Span<T>(static_cast<T *>(info.ptr),
+                          (size_t)(info.size * info.itemsize) / sizeof(T));
+  }
+
+  size_t size() const { return (size_t)(info.size * info.itemsize); }
 
 private:
-  VrEmuTms9918 *t;
+  py::buffer_info info;
 };
 
-Tms9918::Tms9918() { t = vrEmuTms9918New(); }
+static void setRegs(vrEmu::Tms9918 &t, const py::buffer &regs) {
+  ByteBuffer buffer(regs, false);
+  t.writeRegisters(buffer.span<const uint8_t>());
+}
+
+// through the data port, as the original binding did. the address
+// pointer is left after the data
+static void portWriteVram(vrEmu::Tms9918 &t, uint16_t addr, vrEmu::Span<const uint8_t> data) {
+  vrEmuTms9918SetAddressWrite(t.get(), addr);
+  vrEmuTms9918WriteBytes(t.get(), data.data(), data.size());
+}
+
+static void setVram(vrEmu::Tms9918 &t, uint16_t addr, const py::buffer &data) {
+  ByteBuffer buffer(data, false);
+  portWriteVram(t, addr, buffer.span<const uint8_t>());
+}
+
+// direct vram write. doesn't affect the address pointer
+static void writeVram(vrEmu::Tms9918 &t, uint16_t addr, const py::buffer &data) {
+  ByteBuffer buffer(data, false);
+  t.writeVram(addr, buffer.span<const uint8_t>());
+}
+
+static void getVramInto(vrEmu::Tms9918 &t, uint16_t addr, const py::buffer &out) {
+  ByteBuffer buffer(out, true);
+  t.readVram(addr, buffer.span<uint8_t>());
+}
+
+// render into a caller-provided buffer (no allocation)
+template <typename Format>
+static void renderInto(vrEmu::Tms9918 &t, const py::buffer &out) {
+  ByteBuffer buffer(out, true);
+  t.render<Format>(buffer.span<typename Format::Type>());
+}
+
+// port streams. one port access per byte
+static void writeAddrBytes(vrEmu::Tms9918 &t, const py::buffer &data) {
+  ByteBuffer buffer(data, false);
+  t.writeAddr(buffer.span<const uint8_t>());
+}
+
+static void writeDataBytes(vrEmu::Tms9918 &t, const py::buffer &data) {
+  ByteBuffer buffer(data, false);
+  t.writeData(buffer.span<const uint8_t>());
+}
 
-Tms9918::~Tms9918() { vrEmuTms9918Destroy(t); }
+static void readStatusInto(vrEmu::Tms9918 &t, const py::buffer &out) {
+  ByteBuffer buffer(out, true);
+  t.readStatus(buffer.span<uint8_t>());
+}
 
-void Tms9918::setReg(uint8_t reg, uint8_t val) {
-  vrEmuTms9918WriteRegValue(t, vrEmuTms9918Register(reg), val);
+static void readDataInto(vrEmu::Tms9918 &t, const py::buffer &out) {
+  ByteBuffer buffer(out, true);
+  t.readData(buffer.span<uint8_t>());
 }
 
-void Tms9918::setRegs(const std::vector<uint8_t> &val) {
-  for (size_t i = 0; i < val.size(); ++i) {
-    vrEmuTms9918WriteRegValue(t, vrEmuTms9918Register(i), val[i]);
+constexpr size_t FrameBytes = vrEmu::Tms9918::Width * vrEmu::Tms9918::Height;
+
+// frames (palette indexes) that fit in a buffer
+static size_t frameCount(const ByteBuffer &buffer) {
+  const size_t count = buffer.size() / FrameBytes;
+  if (count == 0) {
+    throw py::value_error("buffer must hold at least one frame");
   }
+  return count;
 }
 
-void Tms9918::setVram(uint16_t addr, const std::vector<uint8_t> &data) {
-  vrEmuTms9918SetAddressWrite(t, addr);
-  vrEmuTms9918WriteBytes(t, data.data(), data.size());
+static void runFrame(vrEmu::Tms9918 &t, const py::buffer &out) {
+  ByteBuffer buffer(out, true);
+  t.runFrame(buffer.span<uint8_t>());
 }
 
-std::vector<uint8_t> Tms9918::getScreen() {
-  uint8_t scanline[TMS9918_PIXELS_X]; // scanline buffer
-
-  // an example output (a framebuffer for an SDL texture)
-  std::vector<uint8_t> framebuffer(TMS9918_PIXELS_X * TMS9918_PIXELS_Y * 3);
-
-  // generate all scanlines and render to framebuffer
-  size_t c = 0;
-  for (int y = 0; y < TMS9918_PIXELS_Y; ++y) {
-    // get the scanline pixels
-    vrEmuTms9918ScanLine(t, y, scanline);
-    for (int x = 0; x < TMS9918_PIXELS_X; ++x) {
-      // values returned from vrEmuTms9918ScanLine() are palette indexes
-      // use the vrEmuTms9918Palette array to convert to an RGBA value
-
-      uint32_t col = vrEmuTms9918Palette[scanline[x]];
-      framebuffer[c++] = (col >> 24) & 0xFF;
-      framebuffer[c++] = (col >> 16) & 0xFF;
-      framebuffer[c++] = (col >> 8) & 0xFF;
-    }
+// run as many frames as fit in out, back to back. returns the frame count.
+// the GIL is held throughout: instances aren't thread safe and another
+// python thread could otherwise use this one mid-frame
+static size_t runFrames(vrEmu::Tms9918 &t, const py::buffer &out) {
+  ByteBuffer buffer(out, true);
+  const size_t count = frameCount(buffer);
+  vrEmu::Span<uint8_t> frames = buffer.span<uint8_t>();
+
+  for (size_t i = 0; i < count; ++i) {
+    t.runFrame(frames.subspan(i * FrameBytes, FrameBytes));
   }
-  return framebuffer;
+  return count;
 }
 
-namespace py = pybind11;
+// runs one frame into the next slot of a caller-owned buffer per step and
+// yields a view of it, so a script can drive the ports between frames
+class FrameIterator {
+public:
+  FrameIterator(vrEmu::Tms9918 &t, const py::buffer &out)
+      : t(t), view(py::memoryview(out).attr("cast")("B")), buffer(out, true),
+        count(frameCount(buffer)) {}
+
+  py::object next() {
+    if (index == count) {
+      throw py::stop_iteration();
+    }
+    const size_t offset = index++ * FrameBytes;
+    t.runFrame(buffer.span<uint8_t>().subspan(offset, FrameBytes));
+    return view[py::slice((py::ssize_t)offset, (py::ssize_t)(offset + FrameBytes), 1)];
+  }
+
+private:
+  vrEmu::Tms9918 &t;
+  py::object view;
+  ByteBuffer buffer;
+  size_t count;
+  size_t index = 0;
+};
+
+// many instances stepped and rendered together. per instance data is one
+// buffer split evenly between the instances, so each call crosses into
+// native code once for all of them. the GIL is held throughout, as for
+// runFrames
+class Tms9918Array {
+public:
+  explicit Tms9918Array(size_t count) {
+    if (count == 0) {
+      throw py::value_error("count must be at least 1");
+    }
+    instances.reserve(count);
+    handles.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      instances.emplace_back();
+      handles.push_back(instances.back().get());
+    }
+    lines.resize(count);
+  }
+
+  size_t size() const { return instances.size(); }
+
+  vrEmu::Tms9918 &at(size_t index) {
+    if (index >= instances.size()) {
+      throw py::index_error();
+    }
+    return instances[index];
+  }
+
+  void reset() {
+    for (auto &t : instances) t.reset();
+  }
+
+  // see vrEmuTms9918ResetToTemplate
+  void resetTo(const vrEmu::Tms9918 &templ) {
+    for (auto &t : instances) t.resetTo(templ);
+  }
+
+  // the same registers / vram for every instance
+  void setRegs(const py::buffer &regs) {
+    ByteBuffer buffer(regs, false);
+    for (auto &t : instances) t.writeRegisters(buffer.span<const uint8_t>());
+  }
+
+  void setVram(uint16_t addr, const py::buffer &data) {
+    ByteBuffer buffer(data, false);
+    for (auto &t : instances) portWriteVram(t, addr, buffer.span<const uint8_t>());
+  }
+
+  void writeVram(uint16_t addr, const py::buffer &data) {
+    ByteBuffer buffer(data, false);
+    for (auto &t : instances) t.writeVram(addr, buffer.span<const uint8_t>());
+  }
+
+  // instance i writes the i'th share of data to its port
+  void writeAddrBytes(const py::buffer &data) {
+    forEachShare(data, false, [](vrEmu::Tms9918 &t, vrEmu::Span<uint8_t> share) {
+      t.writeAddr(share);
+    });
+  }
+
+  void writeDataBytes(const py::buffer &data) {
+    forEachShare(data, false, [](vrEmu::Tms9918 &t, vrEmu::Span<uint8_t> share) {
+      t.writeData(share);
+    });
+  }
+
+  // instance i reads its status into the i'th share of out
+  void readStatusInto(const py::buffer &out) {
+    forEachShare(out, true, [](vrEmu::Tms9918 &t, vrEmu::Span<uint8_t> share) {
+      t.readStatus(share);
+    });
+  }
+
+  // one frame per instance (see vrEmuTms9918ScanLineMulti)
+  void render(const py::buffer &out) {
+    ByteBuffer buffer(out, true);
+    uint8_t *frames = framesOf(buffer);
+
+    for (size_t y = 0; y < vrEmu::Tms9918::Height; ++y) {
+      for (size_t i = 0; i < lines.size(); ++i) {
+        lines[i] = frames + i * FrameBytes + y * vrEmu::Tms9918::Width;
+      }
+      vrEmuTms9918ScanLineMulti(handles.data(), (unsigned int)handles.size(),
+                                (uint8_t)y, lines.data());
+    }
+  }
+
+  // run every instance to the end of its frame (see vrEmuTms9918RunFrame)
+  void runFrame(const py::buffer &out) {
+    ByteBuffer buffer(out, true);
+    uint8_t *frames = framesOf(buffer);
+
+    for (size_t i = 0; i < instances.size(); ++i) {
+      instances[i].runFrame(vrEmu::Span<uint8_t>(frames + i * FrameBytes, FrameBytes));
+    }
+  }
+
+private:
+  template <typename Fn>
+  void forEachShare(const py::buffer &data, bool writable, Fn fn) {
+    ByteBuffer buffer(data, writable);
+    if (buffer.size() % instances.size() != 0) {
+      throw py::value_error("buffer size must be a multiple of the instance count");
+    }
+    const size_t share = buffer.size() / instances.size();
+    vrEmu::Span<uint8_t> bytes = buffer.span<uint8_t>();
+    for (size_t i = 0; i < instances.size(); ++i) {
+      fn(instances[i], bytes.subspan(i * share, share));
+    }
+  }
+
+  uint8_t *framesOf(const ByteBuffer &buffer) const {
+    if (buffer.size() < instances.size() * FrameBytes) {
+      throw py::value_error("buffer must hold a frame per instance");
+    }
+    return buffer.span<uint8_t>().data();
+  }
+
+  std::vector<vrEmu::Tms9918> instances;
+  std::vector<VrEmuTms9918 *> handles;
+  std::vector<uint8_t *> lines;
+};
+
+// frame as RGB888 bytes, rendered directly into the new bytes object
+static py::bytes getScreen(vrEmu::Tms9918 &t) {
+  constexpr size_t size = vrEmu::Tms9918::frameSize() * sizeof(vrEmu::Rgb888::Type);
+  PyObject *bytes = PyBytes_FromStringAndSize(nullptr, size);
+  if (bytes == nullptr) {
+    throw py::error_already_set();
+  }
+  py::bytes result = py::reinterpret_steal<py::bytes>(bytes);
+  t.render<vrEmu::Rgb888>(vrEmu::Span<vrEmu::Rgb888::Type>(
+      reinterpret_cast<vrEmu::Rgb888::Type *>(PyBytes_AS_STRING(bytes)),
+      vrEmu::Tms9918::frameSize()));
+  return result;
+}
 
 PYBIND11_MODULE(tms9918, m) {
   m.doc() = "Tms9918"; // optional module docstring
-  py::class_<Tms9918>(m, "Tms9918")
+  m.attr("WIDTH") = vrEmu::Tms9918::Width;
+  m.attr("HEIGHT") = vrEmu::Tms9918::Height;
+  m.attr("FRAME_BYTES") = FrameBytes;
+
+  py::class_<vrEmu::Tms9918>(m, "Tms9918")
       .def(py::init<>())
-      .def("setReg", &Tms9918::setReg)
-      .def("setRegs", &Tms9918::setRegs)
-      .def("setVram", &Tms9918::setVram)
-      .def("getScreen", &Tms9918::getScreen);
+      .def("reset", &vrEmu::Tms9918::reset)
+      .def("writeAddr", py::overload_cast<uint8_t>(&vrEmu::Tms9918::writeAddr))
+      .def("writeData", py::overload_cast<uint8_t>(&vrEmu::Tms9918::writeData))
+      .def("readStatus", py::overload_cast<>(&vrEmu::Tms9918::readStatus))
+      .def("readData", py::overload_cast<>(&vrEmu::Tms9918::readData))
+      .def("writeAddrBytes", &writeAddrBytes)
+      .def("writeDataBytes", &writeDataBytes)
+      .def("readStatusInto", &readStatusInto)
+      .def("readDataInto", &readDataInto)
+      .def("setReg",
+           [](vrEmu::Tms9918 &t, uint8_t reg, uint8_t val) {
+             t.writeRegValue(vrEmuTms9918Register(reg & 0x07), val);
+           })
+      .def("getReg",
+           [](const vrEmu::Tms9918 &t, uint8_t reg) {
+             return t.regValue(vrEmuTms9918Register(reg & 0x07));
+           })
+      .def("setRegs", &setRegs)
+      .def("setRegs",
+           [](vrEmu::Tms9918 &t, const std::vector<uint8_t> &regs) {
+             t.writeRegisters(regs);
+           })
+      .def("setVram", &setVram)
+      .def("setVram",
+           [](vrEmu::Tms9918 &t, uint16_t addr, const std::vector<uint8_t> &data) {
+             portWriteVram(t, addr, data);
+           })
+      .def("writeVram", &writeVram)
+      .def("getVramInto", &getVramInto)
+      .def("getScreen", &getScreen)
+      .def("renderIndexed", &renderInto<vrEmu::Indexed>)
+      .def("renderRgb", &renderInto<vrEmu::Rgb888>)
+      .def("renderRgba", &renderInto<vrEmu::Rgba8888>)
+      .def("renderRgb565", &renderInto<vrEmu::Rgb565>)
+      .def("runFrame", &runFrame)
+      .def("runFrames", &runFrames)
+      .def("frames",
+           [](vrEmu::Tms9918 &t, const py::buffer &out) {
+             return FrameIterator(t, out);
+           },
+           py::keep_alive<0, 1>());
+
+  py::class_<FrameIterator>(m, "FrameIterator")
+      .def("__iter__", [](py::object self) { return self; })
+      .def("__next__", &FrameIterator::next);
+
+  py::class_<Tms9918Array>(m, "Tms9918Array")
+      .def(py::init<size_t>())
+      .def("__len__", &Tms9918Array::size)
+      .def("__getitem__", &Tms9918Array::at, py::return_value_policy::reference_internal)
+      .def("reset", &Tms9918Array::reset)
+      .def("resetTo", &Tms9918Array::resetTo)
+      .def("setRegs", &Tms9918Array::setRegs)
+      .def("setVram", &Tms9918Array::setVram)
+      .def("writeVram", &Tms9918Array::writeVram)
+      .def("writeAddrBytes", &Tms9918Array::writeAddrBytes)
+      .def("writeDataBytes", &Tms9918Array::writeDataBytes)
+      .def("readStatusInto", &Tms9918Array::readStatusInto)
+      .def("render", &Tms9918Array::render)
+      .def("runFrame", &Tms9918Array::runFrame);
 }
@@ -9,12 +9,30 @@
  *
  */
 
+/* posix_memalign, ftruncate and pwrite under strict -std=c11 */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "vrEmuTms9918.h"
 #include <stdlib.h>
 #include <memory.h>
 #include <math.h>
 #include <string.h>
 
+#if defined(_WIN32)
+#include <malloc.h>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define TMS_SHARED_VRAM_WIN32 1
+#elif (defined(__unix__) || defined(__APPLE__)) && !PICO_BUILD
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define TMS_SHARED_VRAM_POSIX 1
+#endif
+
 #if PICO_BUILD
 #include "pico/stdlib.h"
 #define inline __force_inline
@@ -28,9 +46,64 @@
 #endif
 
 
-#define VRAM_SIZE           (1 << 14) /* 16KB */
+#if defined(_MSC_VER)
+#define TMS_ALIGNED(n) __declspec(align(n))
+#else
+#define TMS_ALIGNED(n) __attribute__((aligned(n)))
+#endif
+
+/* write sequence counter primitives (see vrEmuTms9918TrySnapshot) */
+#if defined(_MSC_VER)
+#include <intrin.h>
+#if defined(_M_IX86) || defined(_M_X64)
+#define TMS_FENCE()               _ReadWriteBarrier()
+#else
+#define TMS_FENCE()               MemoryBarrier()
+#endif
+#define TMS_SEQ_LOAD(p)           (*(volatile const uint32_t*)(p))
+#define TMS_SEQ_STORE(p, v)       (*(volatile uint32_t*)(p) = (v))
+#define TMS_FENCE_ACQUIRE()       TMS_FENCE()
+#define TMS_FENCE_RELEASE()       TMS_FENCE()
+#else
+#define TMS_SEQ_LOAD(p)           __atomic_load_n((p), __ATOMIC_RELAXED)
+#define TMS_SEQ_STORE(p, v)       __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define TMS_FENCE_ACQUIRE()       __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define TMS_FENCE_RELEASE()       __atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+
+#define CACHE_LINE_BYTES          64
+
+/* lane expansion for vrEmuTms9918ScanLineMulti. one lane per vector byte */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TMS_MULTI_SSE2 1
+#elif (defined(__ARM_NEON) || defined(_M_ARM64)) && !PICO_BUILD
+#include <arm_neon.h>
+#define TMS_MULTI_NEON 1
+#endif
+
+/* vram access profiler hooks (see vrEmuTms9918SetProfile) */
+#if VR_EMU_TMS9918_PROFILE
+#define TMS_PROFILE_BLOCK(addr)   (((addr) & VRAM_MASK) / TMS_PROFILE_BLOCK_BYTES)
+#define TMS_PROFILE_PORT(tms, counter, addr) \
+  do { if ((tms)->profile) ++(tms)->profile->counter[TMS_PROFILE_BLOCK(addr)]; } while (0)
+#define TMS_PROFILE_FETCH(tms, table, addr, n) \
+  do { if ((tms)->profile) (tms)->profile->fetches[table][TMS_PROFILE_BLOCK(addr)] += (n); } while (0)
+#define TMS_PROFILE_FRAME(tms) \
+  do { if ((tms)->profile) ++(tms)->profile->frames; } while (0)
+#else
+#define TMS_PROFILE_PORT(tms, counter, addr)    ((void)0)
+#define TMS_PROFILE_FETCH(tms, table, addr, n)  ((void)0)
+#define TMS_PROFILE_FRAME(tms)                  ((void)0)
+#endif
+
+#define VRAM_SIZE           (1 << 14) /* 16KB (maximum) */
 #define VRAM_MASK     (VRAM_SIZE - 1) /* 0x3fff */
 
+#define VRAM_DIRTY_BLOCK_SHIFT     8  /* 256 byte blocks (see vrEmuTms9918ResetToTemplate) */
+#define VRAM_DIRTY_BLOCK_BYTES    (1 << VRAM_DIRTY_BLOCK_SHIFT)
+#define VRAM_DIRTY_BLOCKS         (VRAM_SIZE >> VRAM_DIRTY_BLOCK_SHIFT)
+
 #define GRAPHICS_NUM_COLS         32
 #define GRAPHICS_NUM_ROWS         24
 #define GRAPHICS_CHAR_WIDTH        8
@@ -69,17 +142,22 @@
 
  /* PRIVATE DATA STRUCTURE
   * ---------------------- */
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4324) /* structure was padded due to alignment specifier */
+#pragma warning(disable:4200) /* zero-sized array in struct (vramStorage) */
+#endif
+
 struct vrEmuTMS9918_s
 {
+  /* --- hot: cpu port and render state (first cache line) --- */
+
   /* the eight write-only registers */
   uint8_t registers[TMS_NUM_REGISTERS];
 
   /* status register (read-only) */
   uint8_t status;
 
-  /* current address for cpu access (auto-increments) */
-  uint16_t currentAddress;
-
   /* address or register write stage (0 or 1) */
   uint8_t regWriteStage;
 
@@ -89,15 +167,89 @@ struct vrEmuTMS9918_s
   /* buffered value */
   uint8_t readAheadBuffer;
 
+  /* current address for cpu access (auto-increments) */
+  uint16_t currentAddress;
+
   /* current display mode */
   vrEmuTms9918Mode mode;
 
-  /* video ram */
-  uint8_t vram[VRAM_SIZE];
+  /* video ram (vramStorage or a shared copy-on-write mapping) */
+  uint8_t* vram;
+
+  /* vram address mask (size - 1) */
+  uint16_t vramMask;
+
+  /* beam position (see vrEmuTms9918RunCycles) */
+  uint16_t beamLine;
+  uint16_t beamCycle;
+  uint16_t linesPerFrame;
+
+  /* current state of the INT output */
+  bool intActive;
 
-  uint8_t rowSpriteBits[TMS9918_PIXELS_X]; /* collision mask */
+  /* vram blocks written since last copied from templateInstance */
+  uint64_t vramDirty;
+
+  /* --- cold: host bindings --- */
+
+  /* INT output change callback */
+  vrEmuTms9918IntFn intFn;
+  void* intUserData;
+
+  /* deallocator (NULL for caller-provided memory) */
+  vrEmuTms9918FreeFn freeFn;
+  void* freeUserData;
+
+  /* instance last cloned from and its writeSeq at the time */
+  const VrEmuTms9918* templateInstance;
+  uint32_t templateSeq;
+
+  /* cpu vram access timing model (NULL when disabled) */
+  vrEmuTms9918AccessTiming* timing;
+
+#if VR_EMU_TMS9918_PROFILE
+  /* vram access counters (NULL when not profiling) */
+  vrEmuTms9918Profile* profile;
+#endif
+
+  /* register/vram write sequence. odd while a write is in progress.
+     polled by other threads, so kept off the hot line */
+  TMS_ALIGNED(CACHE_LINE_BYTES) uint32_t writeSeq;
+  uint8_t writeSeqPad[CACHE_LINE_BYTES - sizeof(uint32_t)];
+
+  /* collision mask */
+  TMS_ALIGNED(CACHE_LINE_BYTES) uint8_t rowSpriteBits[TMS9918_PIXELS_X];
+
+  /* private video ram. must be last. sized by tmsInstanceSize (none for
+     shared instances, 4KB or 16KB otherwise) */
+  TMS_ALIGNED(CACHE_LINE_BYTES) uint8_t vramStorage[];
+};
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+/* shareable vram image */
+struct vrEmuTms9918VramImage_s
+{
+#if TMS_SHARED_VRAM_WIN32
+  HANDLE mapping;
+#elif TMS_SHARED_VRAM_POSIX
+  int fd;
+#else
+  uint8_t vram[VRAM_SIZE];
+#endif
+  vrEmuTms9918VramSize size;
 };
 
+/* allocator hooks */
+static void* tmsDefaultAlloc(size_t size, size_t alignment, void* userData);
+static void tmsDefaultFree(void* ptr, void* userData);
+
+static vrEmuTms9918AllocFn tmsAllocFn = tmsDefaultAlloc;
+static vrEmuTms9918FreeFn tmsFreeFn = tmsDefaultFree;
+static void* tmsAllocUserData = NULL;
+
 
 /* Function:  tmsMode
  * ----------------------------------------
@@ -150,7 +302,7 @@ static inline bool tmsSpriteMag(VrEmuTms9918* tms9918)
  */
 static inline uint16_t tmsNameTableAddr(VrEmuTms9918* tms9918)
 {
-  return (tms9918->registers[TMS_REG_NAME_TABLE] & 0x0f) << 10;
+  return ((tms9918->registers[TMS_REG_NAME_TABLE] & 0x0f) << 10) & tms9918->vramMask;
 }
 
 /* Function:  tmsColorTableAddr
@@ -161,7 +313,7 @@ static inline uint16_t tmsColorTableAddr(VrEmuTms9918* tms9918)
 {
   const uint8_t mask = (tms9918->mode == TMS_MODE_GRAPHICS_II) ? 0x80 : 0xff;
 
-  return (tms9918->registers[TMS_REG_COLOR_TABLE] & mask) << 6;
+  return ((tms9918->registers[TMS_REG_COLOR_TABLE] & mask) << 6) & tms9918->vramMask;
 }
 
 /* Function:  tmsPatternTableAddr
@@ -172,7 +324,7 @@ static inline uint16_t tmsPatternTableAddr(VrEmuTms9918* tms9918)
 {
   const uint8_t mask = (tms9918->mode == TMS_MODE_GRAPHICS_II) ? 0x04 : 0x07;
 
-  return (tms9918->registers[TMS_REG_PATTERN_TABLE] & mask) << 11;
+  return ((tms9918->registers[TMS_REG_PATTERN_TABLE] & mask) << 11) & tms9918->vramMask;
 }
 
 /* Function:  tmsSpriteAttrTableAddr
@@ -181,7 +333,7 @@ static inline uint16_t tmsPatternTableAddr(VrEmuTms9918* tms9918)
  */
 static inline uint16_t tmsSpriteAttrTableAddr(VrEmuTms9918* tms9918)
 {
-  return (tms9918->registers[TMS_REG_SPRITE_ATTR_TABLE] & 0x7f) << 7;
+  return ((tms9918->registers[TMS_REG_SPRITE_ATTR_TABLE] & 0x7f) << 7) & tms9918->vramMask;
 }
 
 /* Function:  tmsSpritePatternTableAddr
@@ -190,7 +342,7 @@ static inline uint16_t tmsSpriteAttrTableAddr(VrEmuTms9918* tms9918)
  */
 static inline uint16_t tmsSpritePatternTableAddr(VrEmuTms9918* tms9918)
 {
-  return (tms9918->registers[TMS_REG_SPRITE_PATT_TABLE] & 0x07) << 11;
+  return ((tms9918->registers[TMS_REG_SPRITE_PATT_TABLE] & 0x07) << 11) & tms9918->vramMask;
 }
 
 /* Function:  tmsBgColor
@@ -233,21 +385,225 @@ static inline vrEmuTms9918Color tmsBgColor(VrEmuTms9918* tms9918, uint8_t colorB
 }
 
 
+/* Function:  tmsUpdateInt
+ * ----------------------------------------
+ * update the INT output and notify the host if it changed
+ */
+static inline void tmsUpdateInt(VrEmuTms9918* tms9918)
+{
+  const bool active = (tms9918->status & STATUS_INT) && (tms9918->registers[TMS_REG_1] & TMS_R1_INT_ENABLE);
+  if (active != tms9918->intActive)
+  {
+    tms9918->intActive = active;
+    if (tms9918->intFn)
+    {
+      tms9918->intFn(tms9918->intUserData, active);
+    }
+  }
+}
+
+
+/* Function:  tmsDefaultAlloc
+ * ----------------------------------------
+ * default (aligned) allocator
+ */
+static void* tmsDefaultAlloc(size_t size, size_t alignment, void* userData)
+{
+  (void)userData;
+#if defined(_WIN32)
+  return _aligned_malloc(size, alignment);
+#else
+  void* ptr = NULL;
+  return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+#endif
+}
+
+/* Function:  tmsDefaultFree
+ * ----------------------------------------
+ * default deallocator
+ */
+static void tmsDefaultFree(void* ptr, void* userData)
+{
+  (void)userData;
+#if defined(_WIN32)
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+/* Function:  vrEmuTms9918SetAllocator
+ * ----------------------------------------
+ * set the allocator used by vrEmuTms9918New()
+ */
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918SetAllocator(vrEmuTms9918AllocFn allocFn, vrEmuTms9918FreeFn freeFn, void* userData)
+{
+  if (allocFn && freeFn)
+  {
+    tmsAllocFn = allocFn;
+    tmsFreeFn = freeFn;
+    tmsAllocUserData = userData;
+  }
+  else
+  {
+    tmsAllocFn = tmsDefaultAlloc;
+    tmsFreeFn = tmsDefaultFree;
+    tmsAllocUserData = NULL;
+  }
+}
+
+/* Function:  tmsInstanceSize
+ * ----------------------------------------
+ * bytes required for an instance with the given private vram size
+ */
+static inline size_t tmsInstanceSize(size_t vramBytes)
+{
+  const size_t size = offsetof(VrEmuTms9918, vramStorage) + vramBytes;
+  return (size + CACHE_LINE_BYTES - 1) & ~(size_t)(CACHE_LINE_BYTES - 1);
+}
+
+/* Function:  vrEmuTms9918InstanceSize
+ * ----------------------------------------
+ * bytes required for an instance
+ */
+VR_EMU_TMS9918_DLLEXPORT size_t vrEmuTms9918InstanceSize(void)
+{
+  return vrEmuTms9918InstanceSizeWithVram(TMS_VRAM_16K);
+}
+
+/* Function:  vrEmuTms9918InstanceSizeWithVram
+ * ----------------------------------------
+ * bytes required for an instance with the given vram size
+ */
+VR_EMU_TMS9918_DLLEXPORT size_t vrEmuTms9918InstanceSizeWithVram(vrEmuTms9918VramSize vramSize)
+{
+  return tmsInstanceSize(vramSize == TMS_VRAM_4K ? TMS_VRAM_4K : TMS_VRAM_16K);
+}
+
+/* Function:  vrEmuTms9918InstanceAlign
+ * ----------------------------------------
+ * required alignment of instance memory
+ */
+VR_EMU_TMS9918_DLLEXPORT size_t vrEmuTms9918InstanceAlign(void)
+{
+  return CACHE_LINE_BYTES;
+}
+
+/* Function:  tmsInitInstance
+ * ----------------------------------------
+ * initialize instance memory. vram must be set up by the caller
+ */
+static VrEmuTms9918* tmsInitInstance(void* mem, vrEmuTms9918VramSize vramSize)
+{
+  if (mem == NULL || ((uintptr_t)mem & (CACHE_LINE_BYTES - 1)))
+    return NULL;
+
+  VrEmuTms9918* tms9918 = (VrEmuTms9918*)mem;
+  tms9918->vram = tms9918->vramStorage;
+  tms9918->vramMask = (vramSize == TMS_VRAM_4K ? TMS_VRAM_4K : TMS_VRAM_16K) - 1;
+  tms9918->freeFn = NULL;
+  tms9918->freeUserData = NULL;
+  tms9918->intFn = NULL;
+  tms9918->intUserData = NULL;
+  tms9918->linesPerFrame = TMS9918_LINES_PER_FRAME_NTSC;
+  tms9918->writeSeq = 0;
+  tms9918->vramDirty = 0;
+  tms9918->templateInstance = NULL;
+  tms9918->templateSeq = 0;
+  tms9918->timing = NULL;
+#if VR_EMU_TMS9918_PROFILE
+  tms9918->profile = NULL;
+#endif
+  vrEmuTms9918Reset(tms9918);
+
+  return tms9918;
+}
+
+/* Function:  vrEmuTms9918Init
+ * ----------------------------------------
+ * create a new TMS9918 in caller-provided memory
+ */
+VR_EMU_TMS9918_DLLEXPORT VrEmuTms9918* vrEmuTms9918Init(void* mem)
+{
+  return tmsInitInstance(mem, TMS_VRAM_16K);
+}
+
+/* Function:  vrEmuTms9918InitWithVram
+ * ----------------------------------------
+ * create a new TMS9918 with the given vram size in caller-provided memory
+ */
+VR_EMU_TMS9918_DLLEXPORT VrEmuTms9918* vrEmuTms9918InitWithVram(void* mem, vrEmuTms9918VramSize vramSize)
+{
+  return tmsInitInstance(mem, vramSize);
+}
+
 /* Function:  vrEmuTms9918New
  * ----------------------------------------
  * create a new TMS9918
  */
 VR_EMU_TMS9918_DLLEXPORT VrEmuTms9918* vrEmuTms9918New(void)
 {
-  VrEmuTms9918* tms9918 = (VrEmuTms9918*)malloc(sizeof(VrEmuTms9918));
-  if (tms9918 != NULL)
+  return vrEmuTms9918NewWithVram(TMS_VRAM_16K);
+}
+
+/* Function:  vrEmuTms9918NewWithVram
+ * ----------------------------------------
+ * create a new TMS9918 with the given vram size
+ */
+VR_EMU_TMS9918_DLLEXPORT VrEmuTms9918* vrEmuTms9918NewWithVram(vrEmuTms9918VramSize vramSize)
+{
+  const size_t size = vrEmuTms9918InstanceSizeWithVram(vramSize);
+
+  void* mem = tmsAllocFn(size, CACHE_LINE_BYTES, tmsAllocUserData);
+  VrEmuTms9918* tms9918 = tmsInitInstance(mem, vramSize);
+  if (tms9918 == NULL)
   {
-    vrEmuTms9918Reset(tms9918);
+    /* allocation failed or the allocator ignored the alignment */
+    if (mem)
+    {
+      tmsFreeFn(mem, tmsAllocUserData);
+    }
+    return NULL;
   }
 
+  tms9918->freeFn = tmsFreeFn;
+  tms9918->freeUserData = tmsAllocUserData;
+
   return tms9918;
 }
 
+/* Function:  vrEmuTms9918GetVramSize
+ * ----------------------------------------
+ * vram size of this instance
+ */
+VR_EMU_TMS9918_DLLEXPORT vrEmuTms9918VramSize vrEmuTms9918GetVramSize(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL)
+    return TMS_VRAM_16K;
+
+  return (vrEmuTms9918VramSize)(tms9918->vramMask + 1);
+}
+
+/* Function:  tmsWriteBegin
+ * ----------------------------------------
+ * mark the start of a register or vram write (for snapshot readers)
+ */
+static inline void tmsWriteBegin(VrEmuTms9918* tms9918)
+{
+  TMS_SEQ_STORE(&tms9918->writeSeq, tms9918->writeSeq + 1);
+  TMS_FENCE_RELEASE();
+}
+
+/* Function:  tmsWriteEnd
+ * ----------------------------------------
+ * mark the end of a register or vram write
+ */
+static inline void tmsWriteEnd(VrEmuTms9918* tms9918)
+{
+  TMS_FENCE_RELEASE();
+  TMS_SEQ_STORE(&tms9918->writeSeq, tms9918->writeSeq + 1);
+}
+
 /* Function:  vrEmuTms9918Reset
  * ----------------------------------------
  * reset the new TMS9918
@@ -261,7 +617,12 @@ VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918Reset(VrEmuTms9918* tms9918)
     tms9918->regWriteStage = 0;
     tms9918->status = 0;
     tms9918->readAheadBuffer = 0;
+    tmsWriteBegin(tms9918);
     memset(tms9918->registers, 0, sizeof(tms9918->registers));
+    tmsWriteEnd(tms9918);
+    tms9918->beamLine = 0;
+    tms9918->beamCycle = 0;
+    tms9918->intActive = false;
 
     /* ram intentionally left in unknown state */
 
@@ -278,103 +639,488 @@ VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918Reset(VrEmuTms9918* tms9918)
  */
 VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918Destroy(VrEmuTms9918* tms9918)
 {
-  if (tms9918)
+  if (tms9918 == NULL)
+    return;
+
+  if (tms9918->vram != tms9918->vramStorage)
+  {
+#if TMS_SHARED_VRAM_WIN32
+    UnmapViewOfFile(tms9918->vram);
+#elif TMS_SHARED_VRAM_POSIX
+    munmap(tms9918->vram, (size_t)tms9918->vramMask + 1);
+#endif
+  }
+
+  if (tms9918->freeFn)
   {
-    free(tms9918);
+    tms9918->freeFn(tms9918, tms9918->freeUserData);
   }
 }
 
-/* Function:  vrEmuTms9918WriteAddr
+/* Function:  vrEmuTms9918VramImageNew
  * ----------------------------------------
- * write an address (mode = 1) to the tms9918
- *
- * data: the data (DB0 -> DB7) to send
+ * create a shareable image of the current vram of tms9918
  */
-VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918WriteAddr(VrEmuTms9918* tms9918, uint8_t data)
+VR_EMU_TMS9918_DLLEXPORT VrEmuTms9918VramImage* vrEmuTms9918VramImageNew(VrEmuTms9918* tms9918)
 {
-  if (tms9918 == NULL) return;
+  if (tms9918 == NULL)
+    return NULL;
 
-  if (tms9918->regWriteStage == 0)
-  {
-    /* first stage byte - either an address LSB or a register value */
+  VrEmuTms9918VramImage* image = (VrEmuTms9918VramImage*)malloc(sizeof(VrEmuTms9918VramImage));
+  if (image == NULL)
+    return NULL;
 
-    tms9918->regWriteStage0Value = data;
-    tms9918->regWriteStage = 1;
+  image->size = vrEmuTms9918GetVramSize(tms9918);
+
+#if TMS_SHARED_VRAM_WIN32
+  image->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, image->size, NULL);
+  void* view = image->mapping ? MapViewOfFile(image->mapping, FILE_MAP_WRITE, 0, 0, image->size) : NULL;
+  if (view == NULL)
+  {
+    if (image->mapping) CloseHandle(image->mapping);
+    free(image);
+    return NULL;
   }
-  else
+  memcpy(view, tms9918->vram, image->size);
+  UnmapViewOfFile(view);
+#elif TMS_SHARED_VRAM_POSIX
+  /* anonymous shared memory object. unlinked immediately, lives until the fd is closed.
+     the counter keeps names unique across threads */
+  static unsigned int imageCounter = 0;
+  char name[64];
+  snprintf(name, sizeof(name), "/vrEmuTms9918-%ld-%u", (long)getpid(),
+           __atomic_fetch_add(&imageCounter, 1, __ATOMIC_RELAXED));
+
+  image->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (image->fd < 0)
   {
-    /* second byte - either a register number or an address MSB */
-
-    if (data & 0x80) /* register */
-    {
-      tms9918->registers[data & 0x07] = tms9918->regWriteStage0Value;
+    free(image);
+    return NULL;
+  }
+  shm_unlink(name);
 
-      tms9918->mode = tmsMode(tms9918);
-    }
-    else /* address */
-    {
-      tms9918->currentAddress = tms9918->regWriteStage0Value | ((data & 0x3f) << 8);
-      if ((data & 0x40) == 0)
-      {
-        tms9918->readAheadBuffer = tms9918->vram[(tms9918->currentAddress++) & VRAM_MASK];
-      }
-    }
-    tms9918->regWriteStage = 0;
+  if (ftruncate(image->fd, image->size) != 0 ||
+      pwrite(image->fd, tms9918->vram, image->size, 0) != image->size)
+  {
+    close(image->fd);
+    free(image);
+    return NULL;
   }
+#else
+  memcpy(image->vram, tms9918->vram, image->size);
+#endif
+
+  return image;
 }
 
-/* Function:  vrEmuTms9918ReadStatus
+/* Function:  vrEmuTms9918VramImageDestroy
  * ----------------------------------------
- * read from the status register
+ * destroy a vram image
  */
-VR_EMU_TMS9918_DLLEXPORT uint8_t vrEmuTms9918ReadStatus(VrEmuTms9918* tms9918)
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918VramImageDestroy(VrEmuTms9918VramImage* image)
 {
-  if (tms9918 == NULL) return 0;
-
-  const uint8_t tmpStatus = tms9918->status;
-  tms9918->status = 0;
-  tms9918->regWriteStage = 0;
-  return tmpStatus;
+  if (image)
+  {
+#if TMS_SHARED_VRAM_WIN32
+    CloseHandle(image->mapping);
+#elif TMS_SHARED_VRAM_POSIX
+    close(image->fd);
+#endif
+    free(image);
+  }
 }
 
-
-/* Function:  vrEmuTms9918WriteData
+/* Function:  vrEmuTms9918NewShared
  * ----------------------------------------
- * write data (mode = 0) to the tms9918
- *
- * data: the data (DB0 -> DB7) to send
+ * create a new TMS9918 with copy-on-write vram initialized from image
  */
-VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918WriteData(VrEmuTms9918* tms9918, uint8_t data)
+VR_EMU_TMS9918_DLLEXPORT VrEmuTms9918* vrEmuTms9918NewShared(VrEmuTms9918VramImage* image)
 {
-  if (tms9918 == NULL) return;
+  if (image == NULL)
+    return NULL;
 
-  tms9918->regWriteStage = 0;
-  tms9918->readAheadBuffer = data;
-  tms9918->vram[(tms9918->currentAddress++) & VRAM_MASK] = data;
-}
+#if TMS_SHARED_VRAM_WIN32 || TMS_SHARED_VRAM_POSIX
+  /* no private vram storage required */
+  const size_t size = tmsInstanceSize(0);
 
+#if TMS_SHARED_VRAM_WIN32
+  void* vram = MapViewOfFile(image->mapping, FILE_MAP_COPY, 0, 0, image->size);
+  if (vram == NULL)
+    return NULL;
+#else
+  void* vram = mmap(NULL, image->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, image->fd, 0);
+  if (vram == MAP_FAILED)
+    return NULL;
+#endif
 
-/* Function:  vrEmuTms9918ReadData
+  VrEmuTms9918* tms9918 = (VrEmuTms9918*)tmsAllocFn(size, CACHE_LINE_BYTES, tmsAllocUserData);
+  if (tms9918 == NULL)
+  {
+#if TMS_SHARED_VRAM_WIN32
+    UnmapViewOfFile(vram);
+#else
+    munmap(vram, image->size);
+#endif
+    return NULL;
+  }
+
+  VrEmuTms9918* instance = tmsInitInstance(tms9918, image->size);
+  if (instance == NULL)
+  {
+    /* the allocator ignored the alignment */
+    tmsFreeFn(tms9918, tmsAllocUserData);
+#if TMS_SHARED_VRAM_WIN32
+    UnmapViewOfFile(vram);
+#else
+    munmap(vram, image->size);
+#endif
+    return NULL;
+  }
+
+  tms9918 = instance;
+  tms9918->vram = (uint8_t*)vram;
+  tms9918->freeFn = tmsFreeFn;
+  tms9918->freeUserData = tmsAllocUserData;
+#else
+  /* no shared memory support. fall back to a private copy */
+  VrEmuTms9918* tms9918 = vrEmuTms9918NewWithVram(image->size);
+  if (tms9918)
+  {
+    memcpy(tms9918->vram, image->vram, image->size);
+  }
+#endif
+
+  return tms9918;
+}
+
+/* Function:  tmsMarkVramDirty
  * ----------------------------------------
- * read data (mode = 0) from the tms9918
+ * mark the vram blocks covering numBytes from addr as written
  */
-VR_EMU_TMS9918_DLLEXPORT uint8_t vrEmuTms9918ReadData(VrEmuTms9918* tms9918)
+static inline void tmsMarkVramDirty(VrEmuTms9918* tms9918, uint16_t addr, size_t numBytes)
 {
-  if (tms9918 == NULL) return 0;
+  const unsigned int numBlocks = ((unsigned int)tms9918->vramMask + 1) >> VRAM_DIRTY_BLOCK_SHIFT;
+  const size_t spanBlocks = ((addr & (VRAM_DIRTY_BLOCK_BYTES - 1)) + numBytes + VRAM_DIRTY_BLOCK_BYTES - 1) >> VRAM_DIRTY_BLOCK_SHIFT;
 
-  tms9918->regWriteStage = 0;
-  uint8_t currentValue = tms9918->readAheadBuffer;
-  tms9918->readAheadBuffer = tms9918->vram[(tms9918->currentAddress++) & VRAM_MASK];
-  return currentValue;
+  if (spanBlocks >= numBlocks)
+  {
+    tms9918->vramDirty = ~(uint64_t)0 >> (VRAM_DIRTY_BLOCKS - numBlocks);
+    return;
+  }
+
+  unsigned int block = (addr & tms9918->vramMask) >> VRAM_DIRTY_BLOCK_SHIFT;
+  for (size_t i = 0; i < spanBlocks; ++i)
+  {
+    tms9918->vramDirty |= (uint64_t)1 << block;
+    block = (block + 1) & (numBlocks - 1);
+  }
 }
 
-/* Function:  vrEmuTms9918ReadDataNoInc
+/* Function:  tmsCopyInstance
  * ----------------------------------------
- * read data (mode = 0) from the tms9918
+ * copy the emulated state of src to dest, leaving dest's host bindings.
+ * fullCopy == false copies only the vram blocks dest has written since
+ * it was last copied from src
  */
-VR_EMU_TMS9918_DLLEXPORT uint8_t vrEmuTms9918ReadDataNoInc(VrEmuTms9918* tms9918)
+static void tmsCopyInstance(VrEmuTms9918* dest, VrEmuTms9918* src, bool fullCopy)
 {
-  if (tms9918 == NULL) return 0;
+  tmsWriteBegin(dest);
+
+  memcpy(dest->registers, src->registers, sizeof(dest->registers));
+  dest->status = src->status;
+  dest->regWriteStage = src->regWriteStage;
+  dest->regWriteStage0Value = src->regWriteStage0Value;
+  dest->readAheadBuffer = src->readAheadBuffer;
+  dest->currentAddress = src->currentAddress;
+  dest->mode = src->mode;
+  dest->beamLine = src->beamLine;
+  dest->beamCycle = src->beamCycle;
+  dest->linesPerFrame = src->linesPerFrame;
+
+  if (fullCopy)
+  {
+    memcpy(dest->vram, src->vram, (size_t)src->vramMask + 1);
+  }
+  else
+  {
+    uint64_t dirty = dest->vramDirty;
+    for (unsigned int block = 0; dirty; ++block, dirty >>= 1)
+    {
+      if (dirty & 1)
+      {
+        const size_t offset = (size_t)block << VRAM_DIRTY_BLOCK_SHIFT;
+        memcpy(dest->vram + offset, src->vram + offset, VRAM_DIRTY_BLOCK_BYTES);
+      }
+    }
+  }
+
+  dest->vramDirty = 0;
+  dest->templateInstance = src;
+  dest->templateSeq = TMS_SEQ_LOAD(&src->writeSeq);
+
+  tmsWriteEnd(dest);
+
+  /* notify dest's host if INT changed */
+  tmsUpdateInt(dest);
+}
+
+/* Function:  vrEmuTms9918CloneInto
+ * ----------------------------------------
+ * copy the state of src into an existing instance
+ */
+VR_EMU_TMS9918_DLLEXPORT bool vrEmuTms9918CloneInto(VrEmuTms9918* dest, VrEmuTms9918* src)
+{
+  if (dest == NULL || src == NULL || dest->vramMask != src->vramMask)
+    return false;
+
+  if (dest != src)
+  {
+    tmsCopyInstance(dest, src, true);
+  }
+  return true;
+}
+
+/* Function:  vrEmuTms9918Clone
+ * ----------------------------------------
+ * create a new TMS9918 with the state of tms9918
+ */
+VR_EMU_TMS9918_DLLEXPORT VrEmuTms9918* vrEmuTms9918Clone(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL)
+    return NULL;
+
+  VrEmuTms9918* clone = vrEmuTms9918NewWithVram(vrEmuTms9918GetVramSize(tms9918));
+  if (clone != NULL)
+  {
+    tmsCopyInstance(clone, tms9918, true);
+  }
+  return clone;
+}
+
+/* Function:  vrEmuTms9918ResetToTemplate
+ * ----------------------------------------
+ * restore the state of templ, copying only the vram that has diverged
+ */
+VR_EMU_TMS9918_DLLEXPORT bool vrEmuTms9918ResetToTemplate(VrEmuTms9918* tms9918, VrEmuTms9918* templ)
+{
+  if (tms9918 == NULL || templ == NULL || tms9918->vramMask != templ->vramMask)
+    return false;
+
+  if (tms9918 != templ)
+  {
+    /* only the dirty blocks if we were last copied from an unchanged templ */
+    const bool fullCopy = tms9918->templateInstance != templ ||
+                          tms9918->templateSeq != TMS_SEQ_LOAD(&templ->writeSeq);
+    tmsCopyInstance(tms9918, templ, fullCopy);
+  }
+  return true;
+}
+
+/* Function:  tmsAccessSpacing
+ * ----------------------------------------
+ * minimum cycles between cpu vram accesses at the current beam position
+ */
+static inline uint32_t tmsAccessSpacing(VrEmuTms9918* tms9918, uint16_t line)
+{
+  if (line >= TMS9918_PIXELS_Y || !vrEmuTms9918DisplayEnabled(tms9918))
+    return TMS_ACCESS_CYCLES_BLANK;
+
+  switch (tms9918->mode)
+  {
+    case TMS_MODE_TEXT:
+      return TMS_ACCESS_CYCLES_TEXT;
+
+    case TMS_MODE_MULTICOLOR:
+      return TMS_ACCESS_CYCLES_MULTICOLOR;
+
+    default:
+      return TMS_ACCESS_CYCLES_GRAPHICS;
+  }
+}
+
+/* Function:  tmsAccessSlot
+ * ----------------------------------------
+ * account for a cpu vram access against the access timing model. returns
+ * false if the access should be dropped
+ */
+static bool tmsAccessSlot(VrEmuTms9918* tms9918)
+{
+  vrEmuTms9918AccessTiming* timing = tms9918->timing;
+
+  uint64_t now = timing->frameStartCycle +
+                 (uint64_t)tms9918->beamLine * TMS9918_CYCLES_PER_LINE + tms9918->beamCycle;
+  uint16_t line = tms9918->beamLine;
+
+  /* frameStartCycle wraps below zero for the frame the model was set in */
+  if (timing->accessCycleSet && (int64_t)(timing->accessCycle - timing->frameStartCycle) >= 0)
+  {
+    /* host supplied time. the line it falls on, the beam may lag behind */
+    now = timing->accessCycle;
+    line = (uint16_t)(((now - timing->frameStartCycle) / TMS9918_CYCLES_PER_LINE) % tms9918->linesPerFrame);
+  }
+
+  ++timing->frame.accesses;
+  ++timing->total.accesses;
+  timing->lastDelay = 0;
+
+  if (now < timing->nextAccessCycle)
+  {
+    ++timing->frame.tooFast;
+    ++timing->total.tooFast;
+
+    if (timing->policy == TMS_ACCESS_DROP)
+      return false;
+
+    if (timing->policy == TMS_ACCESS_DELAY)
+    {
+      timing->lastDelay = (uint32_t)(timing->nextAccessCycle - now);
+      timing->frame.delayCycles += timing->lastDelay;
+      timing->total.delayCycles += timing->lastDelay;
+      now = timing->nextAccessCycle;
+    }
+  }
+
+  timing->nextAccessCycle = now + tmsAccessSpacing(tms9918, line);
+  return true;
+}
+
+/* Function:  tmsAccessLineComplete
+ * ----------------------------------------
+ * count the access slots of the line under the beam and roll the
+ * frame statistics at the end of the frame
+ */
+static void tmsAccessLineComplete(VrEmuTms9918* tms9918, bool endOfFrame)
+{
+  vrEmuTms9918AccessTiming* timing = tms9918->timing;
+
+  const uint32_t slots = TMS9918_CYCLES_PER_LINE / tmsAccessSpacing(tms9918, tms9918->beamLine);
+  timing->frame.slots += slots;
+  timing->total.slots += slots;
+
+  if (endOfFrame)
+  {
+    timing->lastFrame = timing->frame;
+    memset(&timing->frame, 0, sizeof(timing->frame));
+    timing->frameStartCycle += (uint64_t)tms9918->linesPerFrame * TMS9918_CYCLES_PER_LINE;
+    ++timing->frames;
+  }
+}
+
+/* Function:  vrEmuTms9918WriteAddr
+ * ----------------------------------------
+ * write an address (mode = 1) to the tms9918
+ *
+ * data: the data (DB0 -> DB7) to send
+ */
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918WriteAddr(VrEmuTms9918* tms9918, uint8_t data)
+{
+  if (tms9918 == NULL) return;
+
+  if (tms9918->regWriteStage == 0)
+  {
+    /* first stage byte - either an address LSB or a register value */
+
+    tms9918->regWriteStage0Value = data;
+    tms9918->regWriteStage = 1;
+  }
+  else
+  {
+    /* second byte - either a register number or an address MSB */
+
+    if (data & 0x80) /* register */
+    {
+      tmsWriteBegin(tms9918);
+      tms9918->registers[data & 0x07] = tms9918->regWriteStage0Value;
+      tmsWriteEnd(tms9918);
+
+      tms9918->mode = tmsMode(tms9918);
+      tmsUpdateInt(tms9918);
+    }
+    else /* address */
+    {
+      tms9918->currentAddress = tms9918->regWriteStage0Value | ((data & 0x3f) << 8);
+      if ((data & 0x40) == 0)
+      {
+        TMS_PROFILE_PORT(tms9918, portReads, tms9918->currentAddress & tms9918->vramMask);
+        if (tms9918->timing == NULL || tmsAccessSlot(tms9918))
+        {
+          tms9918->readAheadBuffer = tms9918->vram[tms9918->currentAddress & tms9918->vramMask];
+        }
+        ++tms9918->currentAddress;
+      }
+    }
+    tms9918->regWriteStage = 0;
+  }
+}
+
+/* Function:  vrEmuTms9918ReadStatus
+ * ----------------------------------------
+ * read from the status register
+ */
+VR_EMU_TMS9918_DLLEXPORT uint8_t vrEmuTms9918ReadStatus(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL) return 0;
+
+  const uint8_t tmpStatus = tms9918->status;
+  tms9918->status = 0;
+  tms9918->regWriteStage = 0;
+  tmsUpdateInt(tms9918);
+  return tmpStatus;
+}
+
+
+/* Function:  vrEmuTms9918WriteData
+ * ----------------------------------------
+ * write data (mode = 0) to the tms9918
+ *
+ * data: the data (DB0 -> DB7) to send
+ */
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918WriteData(VrEmuTms9918* tms9918, uint8_t data)
+{
+  if (tms9918 == NULL) return;
+
+  tms9918->regWriteStage = 0;
+  TMS_PROFILE_PORT(tms9918, portWrites, tms9918->currentAddress & tms9918->vramMask);
+  if (tms9918->timing && !tmsAccessSlot(tms9918))
+  {
+    /* too fast. the write is lost and the read-ahead byte left stale */
+    ++tms9918->currentAddress;
+    return;
+  }
+  tms9918->readAheadBuffer = data;
+  tmsWriteBegin(tms9918);
+  tms9918->vramDirty |= (uint64_t)1 << ((tms9918->currentAddress & tms9918->vramMask) >> VRAM_DIRTY_BLOCK_SHIFT);
+  tms9918->vram[(tms9918->currentAddress++) & tms9918->vramMask] = data;
+  tmsWriteEnd(tms9918);
+}
+
+
+/* Function:  vrEmuTms9918ReadData
+ * ----------------------------------------
+ * read data (mode = 0) from the tms9918
+ */
+VR_EMU_TMS9918_DLLEXPORT uint8_t vrEmuTms9918ReadData(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL) return 0;
+
+  tms9918->regWriteStage = 0;
+  uint8_t currentValue = tms9918->readAheadBuffer;
+  TMS_PROFILE_PORT(tms9918, portReads, tms9918->currentAddress & tms9918->vramMask);
+  if (tms9918->timing == NULL || tmsAccessSlot(tms9918))
+  {
+    tms9918->readAheadBuffer = tms9918->vram[tms9918->currentAddress & tms9918->vramMask];
+  }
+  ++tms9918->currentAddress;
+  return currentValue;
+}
+
+/* Function:  vrEmuTms9918ReadDataNoInc
+ * ----------------------------------------
+ * read data (mode = 0) from the tms9918
+ */
+VR_EMU_TMS9918_DLLEXPORT uint8_t vrEmuTms9918ReadDataNoInc(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL) return 0;
 
   return tms9918->readAheadBuffer;
 }
@@ -391,6 +1137,8 @@ static void __time_critical_func(vrEmuTms9918OutputSprites)(VrEmuTms9918* tms991
   const uint8_t spriteSizePx = spriteSize * (spriteMag + 1);
   const uint16_t spriteAttrTableAddr = tmsSpriteAttrTableAddr(tms9918);
   const uint16_t spritePatternAddr = tmsSpritePatternTableAddr(tms9918);
+  const uint8_t* vram = tms9918->vram;
+  const uint16_t vramMask = tms9918->vramMask;
 
   uint8_t spritesShown = 0;
 
@@ -399,9 +1147,10 @@ static void __time_critical_func(vrEmuTms9918OutputSprites)(VrEmuTms9918* tms991
     tms9918->status = 0;
   }
 
-  uint8_t* spriteAttr = tms9918->vram + spriteAttrTableAddr;
+  const uint8_t* spriteAttr = vram + spriteAttrTableAddr;
   for (uint8_t spriteIdx = 0; spriteIdx < MAX_SPRITES; ++spriteIdx)
   {
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_SPRITE_ATTR, spriteAttr - vram, 1);
     int16_t yPos = spriteAttr[SPRITE_ATTR_Y];
 
     /* stop processing when yPos == LAST_SPRITE_YPOS */
@@ -447,6 +1196,7 @@ static void __time_critical_func(vrEmuTms9918OutputSprites)(VrEmuTms9918* tms991
       }
     }
 
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_SPRITE_ATTR, spriteAttr - vram, SPRITE_ATTR_BYTES - 1);
     const uint8_t spriteColor = spriteAttr[SPRITE_ATTR_COLOR] & 0x0f;
 
     /* have we exceeded the scanline sprite limit? */
@@ -466,7 +1216,8 @@ static void __time_critical_func(vrEmuTms9918OutputSprites)(VrEmuTms9918* tms991
     const int16_t earlyClockOffset = (spriteAttr[SPRITE_ATTR_COLOR] & 0x80) ? -32 : 0;
     const int16_t xPos = (int16_t)(spriteAttr[SPRITE_ATTR_X]) + earlyClockOffset;
 
-    int8_t pattByte = tms9918->vram[pattOffset];
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_SPRITE_PATTERN, pattOffset & vramMask, 1);
+    int8_t pattByte = vram[pattOffset & vramMask];
     uint8_t screenBit = 0, pattBit = 0;
 
     int16_t endXPos = xPos + spriteSizePx;
@@ -506,7 +1257,8 @@ static void __time_critical_func(vrEmuTms9918OutputSprites)(VrEmuTms9918* tms991
         if (++pattBit == GRAPHICS_CHAR_WIDTH && sprite16) /* from A -> C or B -> D of large sprite */
         {
           pattBit = 0;
-          pattByte = tms9918->vram[pattOffset + PATTERN_BYTES * 2];
+          TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_SPRITE_PATTERN, (pattOffset + PATTERN_BYTES * 2) & vramMask, 1);
+          pattByte = vram[(pattOffset + PATTERN_BYTES * 2) & vramMask];
         }
       }
     }
@@ -518,49 +1270,67 @@ static void __time_critical_func(vrEmuTms9918OutputSprites)(VrEmuTms9918* tms991
 
 /* Function:  vrEmuTms9918GraphicsIScanLine
  * ----------------------------------------
- * generate a Graphics I mode scanline
+ * generate the background of a Graphics I mode scanline
  */
 static void __time_critical_func(vrEmuTms9918GraphicsIScanLine)(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
 {
   const uint8_t tileY = y >> 3;   /* which name table row (0 - 23) */
   const uint8_t pattRow = y & 0x07;  /* which pattern row (0 - 7) */
+  const uint8_t* vram = tms9918->vram;
 
   /* address in name table at the start of this row */
   const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+  const uint8_t* names = vram + rowNamesAddr;
 
-  const uint8_t* patternTable = tms9918->vram + tmsPatternTableAddr(tms9918);
-  const uint8_t* colorTable = tms9918->vram + tmsColorTableAddr(tms9918);
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+  const uint8_t* colorTable = vram + tmsColorTableAddr(tms9918);
 
   /* iterate over each tile in this row */
   for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
   {
-    const uint8_t pattIdx = tms9918->vram[rowNamesAddr + tileX];
+    const uint8_t pattIdx = names[tileX];
     uint8_t pattByte = patternTable[pattIdx * PATTERN_BYTES + pattRow];
     const uint8_t colorByte = colorTable[pattIdx / GFXI_COLOR_GROUP_SIZE];
 
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, (patternTable - vram) + pattIdx * PATTERN_BYTES + pattRow, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_COLOR, (colorTable - vram) + pattIdx / GFXI_COLOR_GROUP_SIZE, 1);
+
     const uint8_t fgColor = tmsFgColor(tms9918, colorByte);
     const uint8_t bgColor = tmsBgColor(tms9918, colorByte);
 
     /* iterate over each bit of this pattern byte */
+    const uint8_t* tilePixels = pixels;
     for (uint8_t pattBit = 0; pattBit < GRAPHICS_CHAR_WIDTH; ++pattBit)
     {
       const bool pixelBit = pattByte & 0x80;
       *(pixels++) = pixelBit ? fgColor : bgColor;
       pattByte <<= 1;
     }
-  }
 
-  vrEmuTms9918OutputSprites(tms9918, y, pixels - TMS9918_PIXELS_X);
+    /* copy the expanded tile over the rest of a run of identical names */
+    while (tileX + 1 < GRAPHICS_NUM_COLS && names[tileX + 1] == pattIdx)
+    {
+      ++tileX;
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, (patternTable - vram) + pattIdx * PATTERN_BYTES + pattRow, 1);
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_COLOR, (colorTable - vram) + pattIdx / GFXI_COLOR_GROUP_SIZE, 1);
+
+      memcpy(pixels, tilePixels, GRAPHICS_CHAR_WIDTH);
+      pixels += GRAPHICS_CHAR_WIDTH;
+    }
+  }
 }
 
 /* Function:  vrEmuTms9918GraphicsIIScanLine
  * ----------------------------------------
- * generate a Graphics II mode scanline
+ * generate the background of a Graphics II mode scanline
  */
 static void __time_critical_func(vrEmuTms9918GraphicsIIScanLine)(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
 {
   const uint8_t tileY = y >> 3;   /* which name table row (0 - 23) */
   const uint8_t pattRow = y & 0x07;  /* which pattern row (0 - 7) */
+  const uint8_t* vram = tms9918->vram;
 
   /* address in name table at the start of this row */
   const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
@@ -576,19 +1346,23 @@ static void __time_critical_func(vrEmuTms9918GraphicsIIScanLine)(VrEmuTms9918* t
     & (tms9918->registers[TMS_REG_PATTERN_TABLE] & 0x03); /* which page? 0-2 */
   const uint16_t pageOffset = pageThird << 11; /* offset (0, 0x800 or 0x1000) */
 
-  const uint8_t* patternTable = tms9918->vram + tmsPatternTableAddr(tms9918) + pageOffset;
-  const uint8_t* colorTable = tms9918->vram + tmsColorTableAddr(tms9918) + (pageOffset
-    & ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x60) << 6));
+  const uint8_t* patternTable = vram + ((tmsPatternTableAddr(tms9918) + pageOffset) & tms9918->vramMask);
+  const uint8_t* colorTable = vram + ((tmsColorTableAddr(tms9918) + (pageOffset
+    & ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x60) << 6))) & tms9918->vramMask);
 
   /* iterate over each tile in this row */
   for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
   {
-    uint8_t pattIdx = tms9918->vram[rowNamesAddr + tileX] & nameMask;
+    uint8_t pattIdx = vram[rowNamesAddr + tileX] & nameMask;
 
     const size_t pattRowOffset = pattIdx * PATTERN_BYTES + pattRow;
     const uint8_t pattByte = patternTable[pattRowOffset];
     const uint8_t colorByte = colorTable[pattRowOffset];
 
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, (patternTable - vram) + pattRowOffset, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_COLOR, (colorTable - vram) + pattRowOffset, 1);
+
     const vrEmuTms9918Color fgColor = tmsFgColor(tms9918, colorByte);
     const vrEmuTms9918Color bgColor = tmsBgColor(tms9918, colorByte);
 
@@ -599,8 +1373,6 @@ static void __time_critical_func(vrEmuTms9918GraphicsIIScanLine)(VrEmuTms9918* t
       pixels[tileX * GRAPHICS_CHAR_WIDTH + pattBit] = (uint8_t)(pixelBit ? fgColor : bgColor);
     }
   }
-
-  vrEmuTms9918OutputSprites(tms9918, y, pixels);
 }
 
 /* Function:  vrEmuTms9918TextScanLine
@@ -611,10 +1383,12 @@ static void __time_critical_func(vrEmuTms9918TextScanLine)(VrEmuTms9918* tms9918
 {
   const uint8_t tileY = y >> 3;   /* which name table row (0 - 23) */
   const uint8_t pattRow = y & 0x07;  /* which pattern row (0 - 7) */
+  const uint8_t* vram = tms9918->vram;
 
   /* address in name table at the start of this row */
   const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * TEXT_NUM_COLS;
-  const uint8_t* patternTable = tms9918->vram + tmsPatternTableAddr(tms9918);
+  const uint8_t* names = vram + rowNamesAddr;
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
 
   const vrEmuTms9918Color bgColor = tmsMainBgColor(tms9918);
   const vrEmuTms9918Color fgColor = tmsMainFgColor(tms9918);
@@ -625,51 +1399,83 @@ static void __time_critical_func(vrEmuTms9918TextScanLine)(VrEmuTms9918* tms9918
 
   for (uint8_t tileX = 0; tileX < TEXT_NUM_COLS; ++tileX)
   {
-    const uint8_t pattIdx = tms9918->vram[rowNamesAddr + tileX];
+    const uint8_t pattIdx = names[tileX];
     const uint8_t pattByte = patternTable[pattIdx * PATTERN_BYTES + pattRow];
 
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, (patternTable - vram) + pattIdx * PATTERN_BYTES + pattRow, 1);
+
+    uint8_t* tilePixels = pixels + TEXT_PADDING_PX + tileX * TEXT_CHAR_WIDTH;
     for (uint8_t pattBit = 0; pattBit < TEXT_CHAR_WIDTH; ++pattBit)
     {
       bool pixelBit = (pattByte << pattBit) & 0x80;
-      pixels[TEXT_PADDING_PX + tileX * TEXT_CHAR_WIDTH + pattBit] = (uint8_t)(pixelBit ? fgColor : bgColor);
+      tilePixels[pattBit] = (uint8_t)(pixelBit ? fgColor : bgColor);
+    }
+
+    /* copy the expanded character over the rest of a run of identical names */
+    while (tileX + 1 < TEXT_NUM_COLS && names[tileX + 1] == pattIdx)
+    {
+      ++tileX;
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, (patternTable - vram) + pattIdx * PATTERN_BYTES + pattRow, 1);
+
+      memcpy(tilePixels + TEXT_CHAR_WIDTH, tilePixels, TEXT_CHAR_WIDTH);
+      tilePixels += TEXT_CHAR_WIDTH;
     }
   }
 }
 
 /* Function:  vrEmuTms9918MulticolorScanLine
  * ----------------------------------------
- * generate a Multicolor mode scanline
+ * generate the background of a Multicolor mode scanline
  */
 static void __time_critical_func(vrEmuTms9918MulticolorScanLine)(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
 {
   const uint8_t tileY = y >> 3;
   const uint8_t pattRow = ((y / 4) & 0x01) + (tileY & 0x03) * 2;
+  const uint8_t* vram = tms9918->vram;
 
   const uint16_t namesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
-  const uint8_t* patternTable = tms9918->vram + tmsPatternTableAddr(tms9918);
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
 
   for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
   {
-    const uint8_t pattIdx = tms9918->vram[namesAddr + tileX];
+    const uint8_t pattIdx = vram[namesAddr + tileX];
     const uint8_t colorByte = patternTable[pattIdx * PATTERN_BYTES + pattRow];
 
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, namesAddr + tileX, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, (patternTable - vram) + pattIdx * PATTERN_BYTES + pattRow, 1);
+
     memset(pixels + tileX * 8, tmsFgColor(tms9918, colorByte), 4);
     memset(pixels + tileX * 8 + 4, tmsBgColor(tms9918, colorByte), 4);
   }
-
-  vrEmuTms9918OutputSprites(tms9918, y, pixels);
 }
 
 
-/* Function:  vrEmuTms9918ScanLine
+/* Function:  tmsScanLineEnd
  * ----------------------------------------
- * generate a scanline
+ * end of a rendered scanline. update the INT flag
  */
-VR_EMU_TMS9918_DLLEXPORT void __time_critical_func(vrEmuTms9918ScanLine)(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+static inline void tmsScanLineEnd(VrEmuTms9918* tms9918, uint8_t y)
 {
-  if (tms9918 == NULL)
-    return;
+  if (y == TMS9918_PIXELS_Y - 1 && (tms9918->registers[1] & TMS_R1_INT_ENABLE))
+  {
+    tms9918->status |= STATUS_INT;
+  }
 
+  /* status is reset on line 0 and INT raised on the last line */
+  if (y == 0 || y == TMS9918_PIXELS_Y - 1)
+  {
+    tmsUpdateInt(tms9918);
+  }
+}
+
+/* Function:  tmsBackgroundScanLine
+ * ----------------------------------------
+ * generate the background of a scanline
+ */
+static inline void tmsBackgroundScanLine(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
   if (!vrEmuTms9918DisplayEnabled(tms9918) || y >= TMS9918_PIXELS_Y)
   {
     memset(pixels, tmsMainBgColor(tms9918), TMS9918_PIXELS_X);
@@ -694,53 +1500,1195 @@ VR_EMU_TMS9918_DLLEXPORT void __time_critical_func(vrEmuTms9918ScanLine)(VrEmuTm
       vrEmuTms9918MulticolorScanLine(tms9918, y, pixels);
       break;
   }
+}
+
+/* Function:  tmsSpriteScanLine
+ * ----------------------------------------
+ * draw the sprites of a scanline over pixels and update the status
+ */
+static inline void tmsSpriteScanLine(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  if (y == TMS9918_PIXELS_Y - 1)
+  {
+    TMS_PROFILE_FRAME(tms9918);
+  }
 
-  if (y == TMS9918_PIXELS_Y - 1 && (tms9918->registers[1] & TMS_R1_INT_ENABLE))
+  if (y >= TMS9918_PIXELS_Y)
+    return;
+
+  /* a blanked display has no sprites, but the frame still ends (and INT is raised) on line 191 */
+  if (vrEmuTms9918DisplayEnabled(tms9918) && tms9918->mode != TMS_MODE_TEXT)
   {
-    tms9918->status |= STATUS_INT;
+    vrEmuTms9918OutputSprites(tms9918, y, pixels);
   }
+
+  tmsScanLineEnd(tms9918, y);
 }
 
-/* Function:  vrEmuTms9918RegValue
+/* Function:  vrEmuTms9918ScanLine
  * ----------------------------------------
- * return a reigister value
+ * generate a scanline
  */
-VR_EMU_TMS9918_DLLEXPORT
-uint8_t vrEmuTms9918RegValue(VrEmuTms9918* tms9918, vrEmuTms9918Register reg)
+VR_EMU_TMS9918_DLLEXPORT void __time_critical_func(vrEmuTms9918ScanLine)(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
 {
   if (tms9918 == NULL)
-    return 0;
+    return;
 
-  return tms9918->registers[reg & 0x07];
+  tmsBackgroundScanLine(tms9918, y, pixels);
+  tmsSpriteScanLine(tms9918, y, pixels);
 }
 
-/* Function:  vrEmuTms9918WriteRegValue
+/* Function:  vrEmuTms9918BackgroundScanLine
  * ----------------------------------------
- * write a reigister value
+ * generate the background of a scanline
  */
-VR_EMU_TMS9918_DLLEXPORT
-void vrEmuTms9918WriteRegValue(VrEmuTms9918* tms9918, vrEmuTms9918Register reg, uint8_t value)
+VR_EMU_TMS9918_DLLEXPORT void __time_critical_func(vrEmuTms9918BackgroundScanLine)(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
 {
-  if (tms9918 != NULL)
-  {
-    tms9918->registers[reg & 0x07] = value;
-    tms9918->mode = tmsMode(tms9918);
-  }
+  if (tms9918 == NULL)
+    return;
+
+  tmsBackgroundScanLine(tms9918, y, pixels);
 }
 
+/* Function:  vrEmuTms9918SpriteScanLine
+ * ----------------------------------------
+ * draw the sprites of a scanline over pixels
+ */
+VR_EMU_TMS9918_DLLEXPORT void __time_critical_func(vrEmuTms9918SpriteScanLine)(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  if (tms9918 == NULL)
+    return;
 
+  tmsSpriteScanLine(tms9918, y, pixels);
+}
 
-/* Function:  vrEmuTms9918VramValue
+/* Function:  vrEmuTms9918GraphicsIRow
  * ----------------------------------------
- * return a value from vram
+ * generate the background of a Graphics I mode character row
  */
-VR_EMU_TMS9918_DLLEXPORT
-uint8_t vrEmuTms9918VramValue(VrEmuTms9918* tms9918, uint16_t addr)
+static void __time_critical_func(vrEmuTms9918GraphicsIRow)(VrEmuTms9918* tms9918, uint8_t tileY, uint8_t* pixels)
 {
-  if (tms9918 == NULL)
-    return 0;
+  const uint8_t* vram = tms9918->vram;
+
+  /* address in name table at the start of this row */
+  const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+  const uint8_t* names = vram + rowNamesAddr;
+
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+  const uint8_t* colorTable = vram + tmsColorTableAddr(tms9918);
+
+  /* iterate over each tile in this row, emitting all of its pattern rows */
+  for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
+  {
+    const uint8_t pattIdx = names[tileX];
+    const uint8_t* patt = patternTable + pattIdx * PATTERN_BYTES;
+    const uint8_t colorByte = colorTable[pattIdx / GFXI_COLOR_GROUP_SIZE];
+
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, patt - vram, PATTERN_BYTES);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_COLOR, (colorTable - vram) + pattIdx / GFXI_COLOR_GROUP_SIZE, 1);
+
+    const uint8_t fgColor = tmsFgColor(tms9918, colorByte);
+    const uint8_t bgColor = tmsBgColor(tms9918, colorByte);
+
+    uint8_t* tilePixels = pixels + tileX * GRAPHICS_CHAR_WIDTH;
+    uint8_t* linePixels = tilePixels;
+    for (uint8_t pattRow = 0; pattRow < PATTERN_BYTES; ++pattRow, linePixels += TMS9918_PIXELS_X)
+    {
+      uint8_t pattByte = patt[pattRow];
+      for (uint8_t pattBit = 0; pattBit < GRAPHICS_CHAR_WIDTH; ++pattBit)
+      {
+        linePixels[pattBit] = (pattByte & 0x80) ? fgColor : bgColor;
+        pattByte <<= 1;
+      }
+    }
+
+    /* copy the expanded tile over the rest of a run of identical names */
+    for (uint8_t* runPixels = tilePixels + GRAPHICS_CHAR_WIDTH;
+         tileX + 1 < GRAPHICS_NUM_COLS && names[tileX + 1] == pattIdx;
+         runPixels += GRAPHICS_CHAR_WIDTH)
+    {
+      ++tileX;
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, patt - vram, PATTERN_BYTES);
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_COLOR, (colorTable - vram) + pattIdx / GFXI_COLOR_GROUP_SIZE, 1);
+
+      for (uint8_t pattRow = 0; pattRow < PATTERN_BYTES; ++pattRow)
+      {
+        memcpy(runPixels + pattRow * TMS9918_PIXELS_X, tilePixels + pattRow * TMS9918_PIXELS_X, GRAPHICS_CHAR_WIDTH);
+      }
+    }
+  }
+}
+
+/* Function:  vrEmuTms9918GraphicsIIRow
+ * ----------------------------------------
+ * generate the background of a Graphics II mode character row
+ */
+static void __time_critical_func(vrEmuTms9918GraphicsIIRow)(VrEmuTms9918* tms9918, uint8_t tileY, uint8_t* pixels)
+{
+  const uint8_t* vram = tms9918->vram;
+
+  /* address in name table at the start of this row */
+  const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+
+  /* see vrEmuTms9918GraphicsIIScanLine */
+  const uint8_t nameMask = ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x7f) << 3) | 0x07;
+
+  const uint16_t pageThird = ((tileY & 0x18) >> 3)
+    & (tms9918->registers[TMS_REG_PATTERN_TABLE] & 0x03); /* which page? 0-2 */
+  const uint16_t pageOffset = pageThird << 11; /* offset (0, 0x800 or 0x1000) */
+
+  const uint8_t* patternTable = vram + ((tmsPatternTableAddr(tms9918) + pageOffset) & tms9918->vramMask);
+  const uint8_t* colorTable = vram + ((tmsColorTableAddr(tms9918) + (pageOffset
+    & ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x60) << 6))) & tms9918->vramMask);
+
+  /* iterate over each tile in this row, emitting all of its pattern rows */
+  for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
+  {
+    const uint8_t pattIdx = vram[rowNamesAddr + tileX] & nameMask;
+    const uint8_t* patt = patternTable + pattIdx * PATTERN_BYTES;
+    const uint8_t* colors = colorTable + pattIdx * PATTERN_BYTES;
+
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, patt - vram, PATTERN_BYTES);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_COLOR, colors - vram, PATTERN_BYTES);
+
+    uint8_t* tilePixels = pixels + tileX * GRAPHICS_CHAR_WIDTH;
+    for (uint8_t pattRow = 0; pattRow < PATTERN_BYTES; ++pattRow, tilePixels += TMS9918_PIXELS_X)
+    {
+      uint8_t pattByte = patt[pattRow];
+      const uint8_t fgColor = tmsFgColor(tms9918, colors[pattRow]);
+      const uint8_t bgColor = tmsBgColor(tms9918, colors[pattRow]);
+      for (uint8_t pattBit = 0; pattBit < GRAPHICS_CHAR_WIDTH; ++pattBit)
+      {
+        tilePixels[pattBit] = (pattByte & 0x80) ? fgColor : bgColor;
+        pattByte <<= 1;
+      }
+    }
+  }
+}
+
+/* Function:  vrEmuTms9918TextRow
+ * ----------------------------------------
+ * generate a Text mode character row
+ */
+static void __time_critical_func(vrEmuTms9918TextRow)(VrEmuTms9918* tms9918, uint8_t tileY, uint8_t* pixels)
+{
+  const uint8_t* vram = tms9918->vram;
+
+  /* address in name table at the start of this row */
+  const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * TEXT_NUM_COLS;
+  const uint8_t* names = vram + rowNamesAddr;
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+
+  const vrEmuTms9918Color bgColor = tmsMainBgColor(tms9918);
+  const vrEmuTms9918Color fgColor = tmsMainFgColor(tms9918);
+
+  /* fill the first and last 8 pixels of each line with bg color */
+  for (uint8_t pattRow = 0; pattRow < PATTERN_BYTES; ++pattRow)
+  {
+    uint8_t* line = pixels + pattRow * TMS9918_PIXELS_X;
+    memset(line, bgColor, TEXT_PADDING_PX);
+    memset(line + TMS9918_PIXELS_X - TEXT_PADDING_PX, bgColor, TEXT_PADDING_PX);
+  }
+
+  for (uint8_t tileX = 0; tileX < TEXT_NUM_COLS; ++tileX)
+  {
+    const uint8_t pattIdx = names[tileX];
+    const uint8_t* patt = patternTable + pattIdx * PATTERN_BYTES;
+
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, patt - vram, PATTERN_BYTES);
+
+    uint8_t* tilePixels = pixels + TEXT_PADDING_PX + tileX * TEXT_CHAR_WIDTH;
+    uint8_t* linePixels = tilePixels;
+    for (uint8_t pattRow = 0; pattRow < PATTERN_BYTES; ++pattRow, linePixels += TMS9918_PIXELS_X)
+    {
+      uint8_t pattByte = patt[pattRow];
+      for (uint8_t pattBit = 0; pattBit < TEXT_CHAR_WIDTH; ++pattBit)
+      {
+        linePixels[pattBit] = (pattByte & 0x80) ? fgColor : bgColor;
+        pattByte <<= 1;
+      }
+    }
+
+    /* copy the expanded character over the rest of a run of identical names */
+    for (uint8_t* runPixels = tilePixels + TEXT_CHAR_WIDTH;
+         tileX + 1 < TEXT_NUM_COLS && names[tileX + 1] == pattIdx;
+         runPixels += TEXT_CHAR_WIDTH)
+    {
+      ++tileX;
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, rowNamesAddr + tileX, 1);
+      TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, patt - vram, PATTERN_BYTES);
+
+      for (uint8_t pattRow = 0; pattRow < PATTERN_BYTES; ++pattRow)
+      {
+        memcpy(runPixels + pattRow * TMS9918_PIXELS_X, tilePixels + pattRow * TMS9918_PIXELS_X, TEXT_CHAR_WIDTH);
+      }
+    }
+  }
+}
+
+/* Function:  vrEmuTms9918MulticolorRow
+ * ----------------------------------------
+ * generate the background of a Multicolor mode character row
+ */
+static void __time_critical_func(vrEmuTms9918MulticolorRow)(VrEmuTms9918* tms9918, uint8_t tileY, uint8_t* pixels)
+{
+  const uint8_t* vram = tms9918->vram;
+
+  const uint16_t namesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918) + (tileY & 0x03) * 2;
+
+  /* each tile is two color bytes: the top and bottom 4 lines */
+  for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
+  {
+    const uint8_t pattIdx = vram[namesAddr + tileX];
+    const uint8_t* colors = patternTable + pattIdx * PATTERN_BYTES;
+
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_NAME, namesAddr + tileX, 1);
+    TMS_PROFILE_FETCH(tms9918, TMS_PROFILE_PATTERN, colors - vram, 2);
+
+    uint8_t* tilePixels = pixels + tileX * 8;
+    for (uint8_t pattRow = 0; pattRow < PATTERN_BYTES; ++pattRow, tilePixels += TMS9918_PIXELS_X)
+    {
+      const uint8_t colorByte = colors[pattRow / 4];
+      memset(tilePixels, tmsFgColor(tms9918, colorByte), 4);
+      memset(tilePixels + 4, tmsBgColor(tms9918, colorByte), 4);
+    }
+  }
+}
+
+/* Function:  vrEmuTms9918ScanRow
+ * ----------------------------------------
+ * generate the scanlines of a character row
+ */
+VR_EMU_TMS9918_DLLEXPORT void __time_critical_func(vrEmuTms9918ScanRow)(VrEmuTms9918* tms9918, uint8_t row, uint8_t pixels[TMS9918_ROW_LINES * TMS9918_PIXELS_X])
+{
+  if (tms9918 == NULL)
+    return;
+
+  if (row == TMS9918_ROWS - 1)
+  {
+    TMS_PROFILE_FRAME(tms9918);
+  }
+
+  if (!vrEmuTms9918DisplayEnabled(tms9918) || row >= TMS9918_ROWS)
+  {
+    memset(pixels, tmsMainBgColor(tms9918), TMS9918_ROW_LINES * TMS9918_PIXELS_X);
+    if (row < TMS9918_ROWS)
+    {
+      /* blanked, but lines 0 and 191 still reset and raise INT */
+      tmsScanLineEnd(tms9918, (uint8_t)(row * TMS9918_ROW_LINES));
+      tmsScanLineEnd(tms9918, (uint8_t)(row * TMS9918_ROW_LINES + TMS9918_ROW_LINES - 1));
+    }
+    return;
+  }
+
+  switch (tms9918->mode)
+  {
+    case TMS_MODE_GRAPHICS_I:
+      vrEmuTms9918GraphicsIRow(tms9918, row, pixels);
+      break;
+
+    case TMS_MODE_GRAPHICS_II:
+      vrEmuTms9918GraphicsIIRow(tms9918, row, pixels);
+      break;
+
+    case TMS_MODE_TEXT:
+      vrEmuTms9918TextRow(tms9918, row, pixels);
+      break;
+
+    case TMS_MODE_MULTICOLOR:
+      vrEmuTms9918MulticolorRow(tms9918, row, pixels);
+      break;
+  }
+
+  /* sprites and status line by line, as vrEmuTms9918ScanLine would */
+  for (uint8_t line = 0; line < TMS9918_ROW_LINES; ++line)
+  {
+    const uint8_t y = (uint8_t)(row * TMS9918_ROW_LINES + line);
+    if (tms9918->mode != TMS_MODE_TEXT)
+    {
+      vrEmuTms9918OutputSprites(tms9918, y, pixels + line * TMS9918_PIXELS_X);
+    }
+    tmsScanLineEnd(tms9918, y);
+  }
+}
+
+#if TMS_MULTI_SSE2 || TMS_MULTI_NEON
+_Static_assert(TMS_MULTI_MAX_LANES == 16, "one lane per byte of a 128-bit vector");
+#endif
+
+/* Function:  tmsMultiExpand
+ * ----------------------------------------
+ * resolve the colors of one tile for each lane and write its 8 pixels
+ * to out[l] + offset. arrays hold TMS_MULTI_MAX_LANES entries, only the
+ * first lanes are written
+ */
+static inline void tmsMultiExpand(const uint8_t* pattByte, const uint8_t* colorByte, const uint8_t* backdrop,
+                                  uint8_t* const* out, unsigned int lanes, unsigned int offset)
+{
+#if TMS_MULTI_SSE2
+  const __m128i low = _mm_set1_epi8(0x0f);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bits = _mm_set_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+                                    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80);
+  const __m128i color = _mm_loadu_si128((const __m128i*)colorByte);
+  const __m128i bd = _mm_loadu_si128((const __m128i*)backdrop);
+
+  /* transparent -> backdrop */
+  __m128i fg = _mm_and_si128(_mm_srli_epi16(color, 4), low);
+  __m128i bg = _mm_and_si128(color, low);
+  fg = _mm_or_si128(fg, _mm_and_si128(_mm_cmpeq_epi8(fg, zero), bd));
+  bg = _mm_or_si128(bg, _mm_and_si128(_mm_cmpeq_epi8(bg, zero), bd));
+
+  /* broadcast each lane's byte to 8 bytes (two lanes per vector) */
+  __m128i patt[8], diff[8], back[8];
+  const __m128i src[3] = { _mm_loadu_si128((const __m128i*)pattByte), _mm_xor_si128(fg, bg), bg };
+  __m128i* const dst[3] = { patt, diff, back };
+  for (int v = 0; v < 3; ++v)
+  {
+    const __m128i b16[2] = { _mm_unpacklo_epi8(src[v], src[v]), _mm_unpackhi_epi8(src[v], src[v]) };
+    for (int h = 0; h < 2; ++h)
+    {
+      const __m128i b32[2] = { _mm_unpacklo_epi16(b16[h], b16[h]), _mm_unpackhi_epi16(b16[h], b16[h]) };
+      for (int q = 0; q < 2; ++q)
+      {
+        dst[v][h * 4 + q * 2] = _mm_unpacklo_epi32(b32[q], b32[q]);
+        dst[v][h * 4 + q * 2 + 1] = _mm_unpackhi_epi32(b32[q], b32[q]);
+      }
+    }
+  }
+
+  for (unsigned int pair = 0; pair * 2 < lanes; ++pair)
+  {
+    const __m128i set = _mm_cmpeq_epi8(_mm_and_si128(patt[pair], bits), bits);
+    const __m128i px = _mm_xor_si128(back[pair], _mm_and_si128(diff[pair], set));
+    _mm_storel_epi64((__m128i*)(out[pair * 2] + offset), px);
+    if (pair * 2 + 1 < lanes)
+    {
+      _mm_storel_epi64((__m128i*)(out[pair * 2 + 1] + offset), _mm_srli_si128(px, 8));
+    }
+  }
+#elif TMS_MULTI_NEON
+  const uint8x16_t low = vdupq_n_u8(0x0f);
+  static const uint8_t bitsInit[16] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                        0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+  const uint8x16_t bits = vld1q_u8(bitsInit);
+  const uint8x16_t color = vld1q_u8(colorByte);
+  const uint8x16_t bd = vld1q_u8(backdrop);
+
+  /* transparent -> backdrop */
+  uint8x16_t fg = vshrq_n_u8(color, 4);
+  uint8x16_t bg = vandq_u8(color, low);
+  fg = vorrq_u8(fg, vandq_u8(vceqq_u8(fg, vdupq_n_u8(0)), bd));
+  bg = vorrq_u8(bg, vandq_u8(vceqq_u8(bg, vdupq_n_u8(0)), bd));
+
+  /* broadcast each lane's byte to 8 bytes (two lanes per vector) */
+  uint8x16_t patt[8], diff[8], back[8];
+  const uint8x16_t src[3] = { vld1q_u8(pattByte), veorq_u8(fg, bg), bg };
+  uint8x16_t* const dst[3] = { patt, diff, back };
+  for (int v = 0; v < 3; ++v)
+  {
+    const uint8x16x2_t b16 = vzipq_u8(src[v], src[v]);
+    for (int h = 0; h < 2; ++h)
+    {
+      const uint16x8x2_t b32 = vzipq_u16(vreinterpretq_u16_u8(b16.val[h]), vreinterpretq_u16_u8(b16.val[h]));
+      for (int q = 0; q < 2; ++q)
+      {
+        const uint32x4x2_t b64 = vzipq_u32(vreinterpretq_u32_u16(b32.val[q]), vreinterpretq_u32_u16(b32.val[q]));
+        dst[v][h * 4 + q * 2] = vreinterpretq_u8_u32(b64.val[0]);
+        dst[v][h * 4 + q * 2 + 1] = vreinterpretq_u8_u32(b64.val[1]);
+      }
+    }
+  }
+
+  for (unsigned int pair = 0; pair * 2 < lanes; ++pair)
+  {
+    const uint8x16_t px = vbslq_u8(vtstq_u8(patt[pair], bits), veorq_u8(back[pair], diff[pair]), back[pair]);
+    vst1_u8(out[pair * 2] + offset, vget_low_u8(px));
+    if (pair * 2 + 1 < lanes)
+    {
+      vst1_u8(out[pair * 2 + 1] + offset, vget_high_u8(px));
+    }
+  }
+#else
+  for (unsigned int l = 0; l < lanes; ++l)
+  {
+    const uint8_t fg = (colorByte[l] >> 4) ? (colorByte[l] >> 4) : backdrop[l];
+    const uint8_t bg = (colorByte[l] & 0x0f) ? (colorByte[l] & 0x0f) : backdrop[l];
+    const uint8_t diff = fg ^ bg;
+    for (uint8_t pattBit = 0; pattBit < GRAPHICS_CHAR_WIDTH; ++pattBit)
+    {
+      const uint8_t mask = (uint8_t)(0 - ((pattByte[l] >> (7 - pattBit)) & 0x01));
+      out[l][offset + pattBit] = bg ^ (diff & mask);
+    }
+  }
+#endif
+}
+
+/* Function:  vrEmuTms9918ScanLineMulti
+ * ----------------------------------------
+ * generate the same scanline for many instances. graphics i/ii lanes
+ * are gathered together (structure of arrays) and expanded with one
+ * lane per vector byte (see tmsMultiExpand). others render individually
+ */
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918ScanLineMulti(VrEmuTms9918* const* instances, unsigned int count, uint8_t y,
+                                                         uint8_t* const* pixels)
+{
+  if (instances == NULL || pixels == NULL)
+    return;
+
+  const uint8_t tileY = y >> 3;
+  const uint8_t pattRow = y & 0x07;
+
+  for (unsigned int first = 0; first < count; first += TMS_MULTI_MAX_LANES)
+  {
+    const unsigned int chunk = (count - first < TMS_MULTI_MAX_LANES) ? count - first : TMS_MULTI_MAX_LANES;
+
+    /* per-lane state (lanes are compacted graphics i/ii instances) */
+    VrEmuTms9918* lane[TMS_MULTI_MAX_LANES];
+    uint8_t* laneOut[TMS_MULTI_MAX_LANES];
+    const uint8_t* rowNames[TMS_MULTI_MAX_LANES];
+    const uint8_t* patternTable[TMS_MULTI_MAX_LANES];
+    const uint8_t* colorTable[TMS_MULTI_MAX_LANES];
+    uint8_t nameMask[TMS_MULTI_MAX_LANES];
+    uint8_t gfxII[TMS_MULTI_MAX_LANES];
+    uint8_t backdrop[TMS_MULTI_MAX_LANES] = { 0 };
+    unsigned int lanes = 0;
+
+    for (unsigned int i = first; i < first + chunk; ++i)
+    {
+      VrEmuTms9918* tms9918 = instances[i];
+      if (tms9918 == NULL)
+        continue;
+
+      if (y >= TMS9918_PIXELS_Y || !vrEmuTms9918DisplayEnabled(tms9918) ||
+          (tms9918->mode != TMS_MODE_GRAPHICS_I && tms9918->mode != TMS_MODE_GRAPHICS_II))
+      {
+        /* diverged. fall back for this lane */
+        vrEmuTms9918ScanLine(tms9918, y, pixels[i]);
+        continue;
+      }
+
+      const uint8_t* vram = tms9918->vram;
+      lane[lanes] = tms9918;
+      laneOut[lanes] = pixels[i];
+      rowNames[lanes] = vram + tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+      backdrop[lanes] = tmsMainBgColor(tms9918);
+
+      if (tms9918->mode == TMS_MODE_GRAPHICS_II)
+      {
+        /* see vrEmuTms9918GraphicsIIScanLine */
+        const uint16_t pageThird = ((tileY & 0x18) >> 3) & (tms9918->registers[TMS_REG_PATTERN_TABLE] & 0x03);
+        const uint16_t pageOffset = pageThird << 11;
+
+        patternTable[lanes] = vram + ((tmsPatternTableAddr(tms9918) + pageOffset) & tms9918->vramMask);
+        colorTable[lanes] = vram + ((tmsColorTableAddr(tms9918) + (pageOffset
+          & ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x60) << 6))) & tms9918->vramMask);
+        nameMask[lanes] = ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x7f) << 3) | 0x07;
+        gfxII[lanes] = 1;
+      }
+      else
+      {
+        patternTable[lanes] = vram + tmsPatternTableAddr(tms9918);
+        colorTable[lanes] = vram + tmsColorTableAddr(tms9918);
+        nameMask[lanes] = 0xff;
+        gfxII[lanes] = 0;
+      }
+      ++lanes;
+    }
+
+    if (lanes == 0)
+      continue;
+
+    uint8_t pattByte[TMS_MULTI_MAX_LANES] = { 0 };
+    uint8_t colorByte[TMS_MULTI_MAX_LANES] = { 0 };
+
+    for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
+    {
+      /* gather */
+      for (unsigned int l = 0; l < lanes; ++l)
+      {
+        const uint8_t pattIdx = rowNames[l][tileX] & nameMask[l];
+        const size_t pattRowOffset = pattIdx * PATTERN_BYTES + pattRow;
+        const size_t colorOffset = gfxII[l] ? pattRowOffset : (size_t)(pattIdx / GFXI_COLOR_GROUP_SIZE);
+
+        pattByte[l] = patternTable[l][pattRowOffset];
+        colorByte[l] = colorTable[l][colorOffset];
+
+        TMS_PROFILE_FETCH(lane[l], TMS_PROFILE_NAME, (rowNames[l] - lane[l]->vram) + tileX, 1);
+        TMS_PROFILE_FETCH(lane[l], TMS_PROFILE_PATTERN, (patternTable[l] - lane[l]->vram) + pattRowOffset, 1);
+        TMS_PROFILE_FETCH(lane[l], TMS_PROFILE_COLOR, (colorTable[l] - lane[l]->vram) + colorOffset, 1);
+      }
+
+      tmsMultiExpand(pattByte, colorByte, backdrop, laneOut, lanes, tileX * GRAPHICS_CHAR_WIDTH);
+    }
+
+    for (unsigned int l = 0; l < lanes; ++l)
+    {
+      if (y == TMS9918_PIXELS_Y - 1)
+      {
+        TMS_PROFILE_FRAME(lane[l]);
+      }
+      vrEmuTms9918OutputSprites(lane[l], y, laneOut[l]);
+      tmsScanLineEnd(lane[l], y);
+    }
+  }
+}
+
+/* Function:  tmsSampleBackground
+ * ----------------------------------------
+ * evaluate the background of line y at count columns, step apart
+ */
+static void tmsSampleBackground(VrEmuTms9918* tms9918, uint8_t y, unsigned int firstX, unsigned int step,
+                                unsigned int count, uint8_t* out)
+{
+  const uint8_t tileY = y >> 3;
+  const uint8_t pattRow = y & 0x07;
+  const uint8_t* vram = tms9918->vram;
+  unsigned int x = firstX;
+
+  /* tile decoded for the previous sample */
+  unsigned int lastTile = ~0u;
+  uint8_t pattByte = 0, fgColor = 0, bgColor = 0;
+
+  switch (tms9918->mode)
+  {
+    case TMS_MODE_GRAPHICS_I:
+    {
+      const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+      const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+      const uint8_t* colorTable = vram + tmsColorTableAddr(tms9918);
+
+      for (unsigned int i = 0; i < count; ++i, x += step)
+      {
+        const unsigned int tile = x / GRAPHICS_CHAR_WIDTH;
+        if (tile != lastTile)
+        {
+          lastTile = tile;
+          const uint8_t pattIdx = vram[rowNamesAddr + tile];
+          const uint8_t colorByte = colorTable[pattIdx / GFXI_COLOR_GROUP_SIZE];
+          pattByte = patternTable[pattIdx * PATTERN_BYTES + pattRow];
+          fgColor = tmsFgColor(tms9918, colorByte);
+          bgColor = tmsBgColor(tms9918, colorByte);
+        }
+        out[i] = ((pattByte << (x & 0x07)) & 0x80) ? fgColor : bgColor;
+      }
+      break;
+    }
+
+    case TMS_MODE_GRAPHICS_II:
+    {
+      /* see vrEmuTms9918GraphicsIIScanLine */
+      const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+      const uint8_t nameMask = ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x7f) << 3) | 0x07;
+      const uint16_t pageThird = ((tileY & 0x18) >> 3) & (tms9918->registers[TMS_REG_PATTERN_TABLE] & 0x03);
+      const uint16_t pageOffset = pageThird << 11;
+      const uint8_t* patternTable = vram + ((tmsPatternTableAddr(tms9918) + pageOffset) & tms9918->vramMask);
+      const uint8_t* colorTable = vram + ((tmsColorTableAddr(tms9918) + (pageOffset
+        & ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x60) << 6))) & tms9918->vramMask);
+
+      for (unsigned int i = 0; i < count; ++i, x += step)
+      {
+        const unsigned int tile = x / GRAPHICS_CHAR_WIDTH;
+        if (tile != lastTile)
+        {
+          lastTile = tile;
+          const uint8_t pattIdx = vram[rowNamesAddr + tile] & nameMask;
+          const size_t pattRowOffset = pattIdx * PATTERN_BYTES + pattRow;
+          const uint8_t colorByte = colorTable[pattRowOffset];
+          pattByte = patternTable[pattRowOffset];
+          fgColor = tmsFgColor(tms9918, colorByte);
+          bgColor = tmsBgColor(tms9918, colorByte);
+        }
+        out[i] = ((pattByte << (x & 0x07)) & 0x80) ? fgColor : bgColor;
+      }
+      break;
+    }
+
+    case TMS_MODE_TEXT:
+    {
+      const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * TEXT_NUM_COLS;
+      const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+      bgColor = tmsMainBgColor(tms9918);
+      fgColor = tmsMainFgColor(tms9918);
+
+      for (unsigned int i = 0; i < count; ++i, x += step)
+      {
+        if (x < TEXT_PADDING_PX || x >= TMS9918_PIXELS_X - TEXT_PADDING_PX)
+        {
+          out[i] = bgColor;
+          continue;
+        }
+        const unsigned int textX = x - TEXT_PADDING_PX;
+        const unsigned int tile = textX / TEXT_CHAR_WIDTH;
+        if (tile != lastTile)
+        {
+          lastTile = tile;
+          pattByte = patternTable[vram[rowNamesAddr + tile] * PATTERN_BYTES + pattRow];
+        }
+        out[i] = ((pattByte << (textX - tile * TEXT_CHAR_WIDTH)) & 0x80) ? fgColor : bgColor;
+      }
+      break;
+    }
+
+    case TMS_MODE_MULTICOLOR:
+    {
+      const uint8_t mcRow = ((y / 4) & 0x01) + (tileY & 0x03) * 2;
+      const uint16_t namesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+      const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+
+      for (unsigned int i = 0; i < count; ++i, x += step)
+      {
+        const unsigned int tile = x / GRAPHICS_CHAR_WIDTH;
+        if (tile != lastTile)
+        {
+          lastTile = tile;
+          const uint8_t colorByte = patternTable[vram[namesAddr + tile] * PATTERN_BYTES + mcRow];
+          fgColor = tmsFgColor(tms9918, colorByte);
+          bgColor = tmsBgColor(tms9918, colorByte);
+        }
+        out[i] = ((x & 0x07) < 4) ? fgColor : bgColor;
+      }
+      break;
+    }
+  }
+}
+
+/* Function:  tmsSampleLine
+ * ----------------------------------------
+ * evaluate line y (including sprites) at count columns, step apart
+ */
+static void tmsSampleLine(VrEmuTms9918* tms9918, uint8_t y, unsigned int firstX, unsigned int step,
+                          unsigned int count, uint8_t* out)
+{
+  if (!vrEmuTms9918DisplayEnabled(tms9918))
+  {
+    memset(out, tmsMainBgColor(tms9918), count);
+    return;
+  }
+
+  tmsSampleBackground(tms9918, y, firstX, step, count, out);
+
+  if (tms9918->mode == TMS_MODE_TEXT)
+    return;
+
+  /* sprites land on a sentinel-filled line. anything else is a sprite pixel */
+  uint8_t spriteLine[TMS9918_PIXELS_X];
+  memset(spriteLine, 0xff, sizeof(spriteLine));
+  vrEmuTms9918OutputSprites(tms9918, y, spriteLine);
+
+  unsigned int x = firstX;
+  for (unsigned int i = 0; i < count; ++i, x += step)
+  {
+    if (spriteLine[x] != 0xff)
+    {
+      out[i] = spriteLine[x];
+    }
+  }
+}
+
+/* Function:  vrEmuTms9918RenderThumbnail
+ * ----------------------------------------
+ * render a reduced size RGB888 frame
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918RenderThumbnail(VrEmuTms9918* tms9918, uint8_t factor, vrEmuTms9918ThumbnailFilter filter,
+                                 const uint32_t palette[16], uint8_t* rgb, size_t stride)
+{
+  if (tms9918 == NULL || palette == NULL || rgb == NULL || factor == 0 || factor > TMS9918_PIXELS_Y)
+    return;
+
+  const unsigned int width = TMS9918_PIXELS_X / factor;
+  const unsigned int height = TMS9918_PIXELS_Y / factor;
+
+  /* sprite evaluation updates status. this isn't the emulated display */
+  const uint8_t status = tms9918->status;
+#if VR_EMU_TMS9918_PROFILE
+  vrEmuTms9918Profile* profile = tms9918->profile;
+  tms9918->profile = NULL;
+#endif
+
+  uint8_t line[TMS9918_PIXELS_X];
+  uint32_t sums[TMS9918_PIXELS_X][3];
+  uint8_t rgbPalette[16][3];
+
+  for (int c = 0; c < 16; ++c)
+  {
+    rgbPalette[c][0] = (uint8_t)(palette[c] >> 24);
+    rgbPalette[c][1] = (uint8_t)(palette[c] >> 16);
+    rgbPalette[c][2] = (uint8_t)(palette[c] >> 8);
+  }
+
+  for (unsigned int thumbY = 0; thumbY < height; ++thumbY)
+  {
+    uint8_t* out = rgb + thumbY * stride;
+
+    if (filter == TMS_THUMBNAIL_POINT)
+    {
+      /* only evaluate the center pixel of each box */
+      tmsSampleLine(tms9918, (uint8_t)(thumbY * factor + factor / 2), factor / 2, factor, width, line);
+
+      for (unsigned int thumbX = 0; thumbX < width; ++thumbX)
+      {
+        const uint8_t* color = rgbPalette[line[thumbX] & 0x0f];
+        *out++ = color[0];
+        *out++ = color[1];
+        *out++ = color[2];
+      }
+      continue;
+    }
+
+    memset(sums, 0, width * sizeof(sums[0]));
+    for (unsigned int boxY = 0; boxY < factor; ++boxY)
+    {
+      tmsSampleLine(tms9918, (uint8_t)(thumbY * factor + boxY), 0, 1, width * factor, line);
+
+      for (unsigned int x = 0; x < width * factor; ++x)
+      {
+        const uint8_t* color = rgbPalette[line[x] & 0x0f];
+        uint32_t* sum = sums[x / factor];
+        sum[0] += color[0];
+        sum[1] += color[1];
+        sum[2] += color[2];
+      }
+    }
+
+    const uint32_t area = (uint32_t)factor * factor;
+    for (unsigned int thumbX = 0; thumbX < width; ++thumbX)
+    {
+      *out++ = (uint8_t)((sums[thumbX][0] + area / 2) / area);
+      *out++ = (uint8_t)((sums[thumbX][1] + area / 2) / area);
+      *out++ = (uint8_t)((sums[thumbX][2] + area / 2) / area);
+    }
+  }
+
+#if VR_EMU_TMS9918_PROFILE
+  tms9918->profile = profile;
+#endif
+  tms9918->status = status;
+}
+
+/* Function:  tmsCompleteLine
+ * ----------------------------------------
+ * render the line under the beam (if visible) and move to the next line.
+ * returns the completed line
+ */
+static uint16_t tmsCompleteLine(VrEmuTms9918* tms9918, uint8_t* frameBuffer, uint8_t scratch[TMS9918_PIXELS_X])
+{
+  const uint16_t y = tms9918->beamLine;
+  if (y < TMS9918_PIXELS_Y)
+  {
+    vrEmuTms9918ScanLine(tms9918, (uint8_t)y, frameBuffer ? frameBuffer + y * TMS9918_PIXELS_X : scratch);
+  }
+
+  if (tms9918->timing)
+  {
+    tmsAccessLineComplete(tms9918, y + 1 >= tms9918->linesPerFrame);
+  }
+
+  tms9918->beamCycle = 0;
+  if (++tms9918->beamLine >= tms9918->linesPerFrame)
+  {
+    tms9918->beamLine = 0;
+  }
+  return y;
+}
+
+/* Function:  vrEmuTms9918RunCycles
+ * ----------------------------------------
+ * advance the beam, rendering each completed line
+ */
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918RunCycles(VrEmuTms9918* tms9918, uint32_t cycles, uint8_t* frameBuffer)
+{
+  if (tms9918 == NULL)
+    return;
+
+  uint8_t scratch[TMS9918_PIXELS_X];
+
+  if (tms9918->timing)
+  {
+    tms9918->timing->accessCycleSet = false;
+  }
+
+  while (cycles)
+  {
+    const uint32_t lineRemaining = TMS9918_CYCLES_PER_LINE - tms9918->beamCycle;
+    if (cycles < lineRemaining)
+    {
+      tms9918->beamCycle += (uint16_t)cycles;
+      break;
+    }
+    cycles -= lineRemaining;
+
+    tmsCompleteLine(tms9918, frameBuffer, scratch);
+  }
+}
+
+/* Function:  vrEmuTms9918RunFrame
+ * ----------------------------------------
+ * run to the end of the current frame, delivering blocks of lines
+ * as they complete
+ */
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918RunFrame(VrEmuTms9918* tms9918, uint8_t* frameBuffer, uint8_t linesPerBlock,
+                                                   vrEmuTms9918LineBlockFn blockFn, void* userData)
+{
+  if (tms9918 == NULL || frameBuffer == NULL)
+    return;
+
+  if (linesPerBlock == 0)
+  {
+    linesPerBlock = 1;
+  }
+
+  if (tms9918->timing)
+  {
+    tms9918->timing->accessCycleSet = false;
+  }
+
+  vrEmuTms9918LineBlock block;
+  block.numLines = 0;
+
+  do
+  {
+    const uint16_t y = tmsCompleteLine(tms9918, frameBuffer, NULL);
+    if (y >= TMS9918_PIXELS_Y)
+      continue;
+
+    if (block.numLines == 0)
+    {
+      block.firstLine = (uint8_t)y;
+      block.pixels = frameBuffer + y * TMS9918_PIXELS_X;
+    }
+
+    if (++block.numLines == linesPerBlock || y == TMS9918_PIXELS_Y - 1)
+    {
+      block.completeCycle = (uint32_t)(y + 1) * TMS9918_CYCLES_PER_LINE;
+      if (blockFn)
+      {
+        blockFn(userData, &block);
+      }
+      block.numLines = 0;
+    }
+  } while (tms9918->beamLine != 0);
+}
+
+/* Function:  vrEmuTms9918CyclesToInterrupt
+ * ----------------------------------------
+ * cycles until the end of the active display (when INT is raised)
+ */
+VR_EMU_TMS9918_DLLEXPORT uint32_t vrEmuTms9918CyclesToInterrupt(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL)
+    return 0;
+
+  const uint32_t lastLine = TMS9918_PIXELS_Y - 1;
+  const uint32_t lines = (lastLine + tms9918->linesPerFrame - tms9918->beamLine) % tms9918->linesPerFrame;
+
+  return lines * TMS9918_CYCLES_PER_LINE + (TMS9918_CYCLES_PER_LINE - tms9918->beamCycle);
+}
+
+/* Function:  vrEmuTms9918BeamLine
+ * ----------------------------------------
+ * current beam line (0 to lines per frame - 1)
+ */
+VR_EMU_TMS9918_DLLEXPORT uint16_t vrEmuTms9918BeamLine(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL)
+    return 0;
+
+  return tms9918->beamLine;
+}
+
+/* Function:  vrEmuTms9918SetLinesPerFrame
+ * ----------------------------------------
+ * set the total lines per frame
+ */
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918SetLinesPerFrame(VrEmuTms9918* tms9918, uint16_t lines)
+{
+  if (tms9918 == NULL || lines < TMS9918_PIXELS_Y)
+    return;
+
+  tms9918->linesPerFrame = lines;
+  if (tms9918->beamLine >= lines)
+  {
+    tms9918->beamLine = 0;
+  }
+}
+
+/* Function:  vrEmuTms9918InterruptActive
+ * ----------------------------------------
+ * current state of the INT output
+ */
+VR_EMU_TMS9918_DLLEXPORT bool vrEmuTms9918InterruptActive(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL)
+    return false;
+
+  return tms9918->intActive;
+}
+
+/* Function:  vrEmuTms9918SetInterruptCallback
+ * ----------------------------------------
+ * set a callback for INT output changes
+ */
+VR_EMU_TMS9918_DLLEXPORT void vrEmuTms9918SetInterruptCallback(VrEmuTms9918* tms9918, vrEmuTms9918IntFn intFn, void* userData)
+{
+  if (tms9918 == NULL)
+    return;
+
+  tms9918->intFn = intFn;
+  tms9918->intUserData = userData;
+}
+
+/* Function:  vrEmuTms9918SetProfile
+ * ----------------------------------------
+ * attach vram access counters
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918SetProfile(VrEmuTms9918* tms9918, vrEmuTms9918Profile* profile)
+{
+  if (tms9918 == NULL)
+    return false;
+
+#if VR_EMU_TMS9918_PROFILE
+  tms9918->profile = profile;
+  return true;
+#else
+  (void)profile;
+  return false;
+#endif
+}
+
+/* Function:  vrEmuTms9918SetAccessTiming
+ * ----------------------------------------
+ * attach a cpu vram access timing model
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetAccessTiming(VrEmuTms9918* tms9918, vrEmuTms9918AccessTiming* timing)
+{
+  if (tms9918 == NULL)
+    return;
+
+  if (timing)
+  {
+    /* cycle 0 is now, part way through the current frame. statistics
+       are left to the caller */
+    timing->frameStartCycle = 0 - ((uint64_t)tms9918->beamLine * TMS9918_CYCLES_PER_LINE + tms9918->beamCycle);
+    timing->nextAccessCycle = 0;
+    timing->accessCycle = 0;
+    timing->accessCycleSet = false;
+    timing->lastDelay = 0;
+  }
+  tms9918->timing = timing;
+}
+
+/* Function:  vrEmuTms9918SetAccessCycle
+ * ----------------------------------------
+ * time the following cpu vram accesses at the given cycle
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetAccessCycle(VrEmuTms9918* tms9918, uint64_t cycle)
+{
+  if (tms9918 == NULL || tms9918->timing == NULL)
+    return;
+
+  tms9918->timing->accessCycle = cycle;
+  tms9918->timing->accessCycleSet = true;
+}
+
+/* Function:  vrEmuTms9918RegValue
+ * ----------------------------------------
+ * return a reigister value
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918RegValue(VrEmuTms9918* tms9918, vrEmuTms9918Register reg)
+{
+  if (tms9918 == NULL)
+    return 0;
+
+  return tms9918->registers[reg & 0x07];
+}
+
+/* Function:  vrEmuTms9918WriteRegValue
+ * ----------------------------------------
+ * write a reigister value
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918WriteRegValue(VrEmuTms9918* tms9918, vrEmuTms9918Register reg, uint8_t value)
+{
+  if (tms9918 != NULL)
+  {
+    tmsWriteBegin(tms9918);
+    tms9918->registers[reg & 0x07] = value;
+    tmsWriteEnd(tms9918);
+    tms9918->mode = tmsMode(tms9918);
+    tmsUpdateInt(tms9918);
+  }
+}
+
+
+
+/* Function:  vrEmuTms9918VramValue
+ * ----------------------------------------
+ * return a value from vram
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918VramValue(VrEmuTms9918* tms9918, uint16_t addr)
+{
+  if (tms9918 == NULL)
+    return 0;
+
+  return tms9918->vram[addr & tms9918->vramMask];
+}
+
+/* Function:  vrEmuTms9918ReadVram
+ * ----------------------------------------
+ * copy a block of vram (wraps at the end of vram)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ReadVram(VrEmuTms9918* tms9918, uint16_t addr, uint8_t* dest, size_t numBytes)
+{
+  if (tms9918 == NULL || dest == NULL)
+    return;
+
+  while (numBytes)
+  {
+    addr &= tms9918->vramMask;
+    size_t chunk = (size_t)tms9918->vramMask + 1 - addr;
+    if (chunk > numBytes) chunk = numBytes;
+
+    memcpy(dest, tms9918->vram + addr, chunk);
+    dest += chunk;
+    addr += (uint16_t)chunk;
+    numBytes -= chunk;
+  }
+}
+
+/* Function:  vrEmuTms9918WriteVram
+ * ----------------------------------------
+ * bulk write a block of vram (wraps at the end of vram)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918WriteVram(VrEmuTms9918* tms9918, uint16_t addr, const uint8_t* src, size_t numBytes)
+{
+  if (tms9918 == NULL || src == NULL)
+    return;
+
+  tmsWriteBegin(tms9918);
+  tmsMarkVramDirty(tms9918, addr, numBytes);
+  while (numBytes)
+  {
+    addr &= tms9918->vramMask;
+    size_t chunk = (size_t)tms9918->vramMask + 1 - addr;
+    if (chunk > numBytes) chunk = numBytes;
+
+    memcpy(tms9918->vram + addr, src, chunk);
+    src += chunk;
+    addr += (uint16_t)chunk;
+    numBytes -= chunk;
+  }
+  tmsWriteEnd(tms9918);
+}
+
+/* Function:  vrEmuTms9918WriteEpoch
+ * ----------------------------------------
+ * register/vram write counter
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint32_t vrEmuTms9918WriteEpoch(VrEmuTms9918* tms9918)
+{
+  if (tms9918 == NULL)
+    return 0;
+
+  const uint32_t seq = TMS_SEQ_LOAD(&tms9918->writeSeq);
+  TMS_FENCE_ACQUIRE();
+  return seq >> 1;
+}
+
+/* Function:  vrEmuTms9918TrySnapshot
+ * ----------------------------------------
+ * copy registers and vram without blocking the writer. returns false
+ * if a write raced the copy
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918TrySnapshot(VrEmuTms9918* tms9918, uint8_t registers[TMS_NUM_REGISTERS], uint8_t* vram)
+{
+  if (tms9918 == NULL)
+    return false;
+
+  const uint32_t seqBefore = TMS_SEQ_LOAD(&tms9918->writeSeq);
+  TMS_FENCE_ACQUIRE();
+  if (seqBefore & 1)
+    return false;
+
+  if (registers)
+  {
+    memcpy(registers, tms9918->registers, TMS_NUM_REGISTERS);
+  }
+  if (vram)
+  {
+    memcpy(vram, tms9918->vram, (size_t)tms9918->vramMask + 1);
+  }
+
+  TMS_FENCE_ACQUIRE();
+  return TMS_SEQ_LOAD(&tms9918->writeSeq) == seqBefore;
+}
+
+/* Function:  vrEmuTms9918Snapshot
+ * ----------------------------------------
+ * vrEmuTms9918TrySnapshot with up to maxAttempts attempts (0 = unlimited)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918Snapshot(VrEmuTms9918* tms9918, uint8_t registers[TMS_NUM_REGISTERS], uint8_t* vram, unsigned int maxAttempts)
+{
+  if (tms9918 == NULL)
+    return false;
+
+  for (unsigned int attempt = 0; maxAttempts == 0 || attempt < maxAttempts; ++attempt)
+  {
+    if (vrEmuTms9918TrySnapshot(tms9918, registers, vram))
+      return true;
+  }
+  return false;
+}
+
+/* Function:  vrEmuTms9918GetPortState
+ * ----------------------------------------
+ * get the cpu port latch state
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918GetPortState(VrEmuTms9918* tms9918, vrEmuTms9918PortState* state)
+{
+  if (tms9918 == NULL || state == NULL)
+    return;
+
+  state->status = tms9918->status;
+  state->regWriteStage = tms9918->regWriteStage;
+  state->regWriteStage0Value = tms9918->regWriteStage0Value;
+  state->readAheadBuffer = tms9918->readAheadBuffer;
+  state->currentAddress = tms9918->currentAddress;
+}
+
+/* Function:  vrEmuTms9918SetPortState
+ * ----------------------------------------
+ * restore the cpu port latch state
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetPortState(VrEmuTms9918* tms9918, const vrEmuTms9918PortState* state)
+{
+  if (tms9918 == NULL || state == NULL)
+    return;
 
-  return tms9918->vram[addr & VRAM_MASK];
+  tms9918->status = state->status;
+  tms9918->regWriteStage = state->regWriteStage & 0x01;
+  tms9918->regWriteStage0Value = state->regWriteStage0Value;
+  tms9918->readAheadBuffer = state->readAheadBuffer;
+  tms9918->currentAddress = state->currentAddress & VRAM_MASK;
+  tmsUpdateInt(tms9918);
 }
 
 /* Function:  vrEmuTms9918DisplayEnabled
@@ -47,12 +47,16 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /* PRIVATE DATA STRUCTURE
  * ---------------------------------------- */
 struct vrEmuTMS9918_s;
 typedef struct vrEmuTMS9918_s VrEmuTms9918;
 
+struct vrEmuTms9918VramImage_s;
+typedef struct vrEmuTms9918VramImage_s VrEmuTms9918VramImage;
+
 typedef enum
 {
   TMS_MODE_GRAPHICS_I,
@@ -61,6 +65,12 @@ typedef enum
   TMS_MODE_MULTICOLOR,
 } vrEmuTms9918Mode;
 
+typedef enum
+{
+  TMS_VRAM_4K  = 0x1000,  /* 4027-based systems. addresses fold every 4KB */
+  TMS_VRAM_16K = 0x4000,
+} vrEmuTms9918VramSize;
+
 typedef enum
 {
   TMS_TRANSPARENT = 0,
@@ -103,6 +113,114 @@ typedef enum
 #define TMS9918_PIXELS_X 256
 #define TMS9918_PIXELS_Y 192
 
+/* character rows (see vrEmuTms9918ScanRow) */
+#define TMS9918_ROW_LINES  8
+#define TMS9918_ROWS       (TMS9918_PIXELS_Y / TMS9918_ROW_LINES)
+
+/* timing (cycles are pixel clocks, 5.369318 MHz) */
+#define TMS9918_CLOCK_HZ              5369318
+#define TMS9918_CYCLES_PER_LINE       342
+#define TMS9918_LINES_PER_FRAME_NTSC  262   /* TMS9918A / TMS9928A */
+#define TMS9918_LINES_PER_FRAME_PAL   313   /* TMS9929A */
+
+/* instances rendered together by vrEmuTms9918ScanLineMulti */
+#define TMS_MULTI_MAX_LANES           16
+
+/* INT output change callback */
+typedef void (*vrEmuTms9918IntFn)(void* userData, bool active);
+
+/* a block of completed lines (see vrEmuTms9918RunFrame) */
+typedef struct
+{
+  uint8_t firstLine;
+  uint8_t numLines;
+  const uint8_t* pixels;     /* numLines * TMS9918_PIXELS_X palette indexes */
+  uint32_t completeCycle;    /* cycle within the frame the last line completes on hardware */
+} vrEmuTms9918LineBlock;
+
+typedef void (*vrEmuTms9918LineBlockFn)(void* userData, const vrEmuTms9918LineBlock* block);
+
+/* thumbnail filtering (see vrEmuTms9918RenderThumbnail) */
+typedef enum
+{
+  TMS_THUMBNAIL_POINT,    /* nearest (center) pixel of each box */
+  TMS_THUMBNAIL_BOX,      /* average of each box */
+} vrEmuTms9918ThumbnailFilter;
+
+/* vram access profile (see vrEmuTms9918SetProfile) */
+#define TMS_PROFILE_BLOCK_BYTES   64
+#define TMS_PROFILE_BLOCKS        (TMS_VRAM_16K / TMS_PROFILE_BLOCK_BYTES)
+
+typedef enum
+{
+  TMS_PROFILE_NAME,
+  TMS_PROFILE_COLOR,
+  TMS_PROFILE_PATTERN,
+  TMS_PROFILE_SPRITE_ATTR,
+  TMS_PROFILE_SPRITE_PATTERN,
+  TMS_PROFILE_NUM_TABLES,
+} vrEmuTms9918ProfileTable;
+
+typedef struct
+{
+  uint32_t portWrites[TMS_PROFILE_BLOCKS];    /* vrEmuTms9918WriteData */
+  uint32_t portReads[TMS_PROFILE_BLOCKS];     /* vrEmuTms9918ReadData (and address read-ahead) */
+  uint32_t fetches[TMS_PROFILE_NUM_TABLES][TMS_PROFILE_BLOCKS];  /* renderer */
+  uint32_t frames;                            /* frames rendered */
+} vrEmuTms9918Profile;
+
+/* cpu vram access timing (see vrEmuTms9918SetAccessTiming). minimum
+   cycles between accesses through the data port */
+#define TMS_ACCESS_CYCLES_BLANK       11  /* 2us. vertical blanking or display disabled */
+#define TMS_ACCESS_CYCLES_TEXT        17  /* 3.1us. active display, text mode */
+#define TMS_ACCESS_CYCLES_MULTICOLOR  19  /* 3.5us. active display, multicolor mode */
+#define TMS_ACCESS_CYCLES_GRAPHICS    43  /* 8us. active display, graphics i and ii */
+
+typedef enum
+{
+  TMS_ACCESS_ACCEPT,    /* perform too-fast accesses anyway (count only) */
+  TMS_ACCESS_DROP,      /* too-fast writes are lost, reads return the stale read-ahead byte */
+  TMS_ACCESS_DELAY,     /* too-fast accesses wait for the next slot. the host stalls for lastDelay */
+} vrEmuTms9918AccessPolicy;
+
+typedef struct
+{
+  uint32_t accesses;      /* cpu vram accesses (data port and address read-ahead) */
+  uint32_t tooFast;       /* accesses sooner than the access window allowed */
+  uint32_t delayCycles;   /* cycles waited by too-fast accesses (TMS_ACCESS_DELAY) */
+  uint32_t slots;         /* access slots available (bandwidth use = accesses / slots) */
+} vrEmuTms9918AccessStats;
+
+typedef struct
+{
+  vrEmuTms9918AccessPolicy policy;
+  vrEmuTms9918AccessStats frame;        /* current frame so far */
+  vrEmuTms9918AccessStats lastFrame;    /* last completed frame */
+  vrEmuTms9918AccessStats total;
+  uint32_t frames;                      /* frames completed */
+  uint32_t lastDelay;                   /* wait of the latest access (TMS_ACCESS_DELAY) */
+
+  /* private */
+  uint64_t frameStartCycle;
+  uint64_t nextAccessCycle;
+  uint64_t accessCycle;                 /* see vrEmuTms9918SetAccessCycle */
+  bool accessCycleSet;
+} vrEmuTms9918AccessTiming;
+
+/* custom allocator hooks */
+typedef void* (*vrEmuTms9918AllocFn)(size_t size, size_t alignment, void* userData);
+typedef void (*vrEmuTms9918FreeFn)(void* ptr, void* userData);
+
+/* cpu port latch state (save / restore, tracing) */
+typedef struct
+{
+  uint8_t  status;
+  uint8_t  regWriteStage;
+  uint8_t  regWriteStage0Value;
+  uint8_t  readAheadBuffer;
+  uint16_t currentAddress;
+} vrEmuTms9918PortState;
+
 
 /* PUBLIC INTERFACE
  * ---------------------------------------- */
@@ -114,6 +232,75 @@ typedef enum
 VR_EMU_TMS9918_DLLEXPORT
 VrEmuTms9918* vrEmuTms9918New(void);
 
+/* Function:  vrEmuTms9918NewWithVram
+ * --------------------
+ * create a new TMS9918 with the given vram size
+ *
+ * only the required vram is allocated. a 4KB instance folds all vram
+ * addresses (cpu and rendering) to 12 bits, regardless of TMS_R1_RAM_16K
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918* vrEmuTms9918NewWithVram(vrEmuTms9918VramSize vramSize);
+
+/* Function:  vrEmuTms9918GetVramSize
+ * --------------------
+ * vram size of this instance
+ */
+VR_EMU_TMS9918_DLLEXPORT
+vrEmuTms9918VramSize vrEmuTms9918GetVramSize(VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918SetAllocator
+ * --------------------
+ * set the allocator used by vrEmuTms9918New() (NULL to restore the default)
+ *
+ * allocFn must return memory aligned to the requested alignment. each
+ * instance remembers the freeFn it was allocated with
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetAllocator(vrEmuTms9918AllocFn allocFn, vrEmuTms9918FreeFn freeFn, void* userData);
+
+/* Function:  vrEmuTms9918InstanceSize
+ * --------------------
+ * bytes required for an instance (see vrEmuTms9918Init)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918InstanceSize(void);
+
+/* Function:  vrEmuTms9918InstanceSizeWithVram
+ * --------------------
+ * bytes required for an instance with the given vram size
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918InstanceSizeWithVram(vrEmuTms9918VramSize vramSize);
+
+/* Function:  vrEmuTms9918InstanceAlign
+ * --------------------
+ * required alignment of instance memory (see vrEmuTms9918Init)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918InstanceAlign(void);
+
+/* Function:  vrEmuTms9918Init
+ * --------------------
+ * create a new TMS9918 in caller-provided memory
+ *
+ * mem: vrEmuTms9918InstanceSize() bytes aligned to vrEmuTms9918InstanceAlign()
+ *
+ * returns NULL if mem is misaligned. the caller owns the memory.
+ * vrEmuTms9918Destroy() won't free it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918* vrEmuTms9918Init(void* mem);
+
+/* Function:  vrEmuTms9918InitWithVram
+ * --------------------
+ * create a new TMS9918 with the given vram size in caller-provided memory
+ *
+ * mem: vrEmuTms9918InstanceSizeWithVram() bytes aligned to vrEmuTms9918InstanceAlign()
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918* vrEmuTms9918InitWithVram(void* mem, vrEmuTms9918VramSize vramSize);
+
 /* Function:  vrEmuTms9918Reset
   * --------------------
   * reset the new TMS9918
@@ -130,6 +317,66 @@ void vrEmuTms9918Reset(VrEmuTms9918* tms9918);
 VR_EMU_TMS9918_DLLEXPORT
 void vrEmuTms9918Destroy(VrEmuTms9918* tms9918);
 
+/* Function:  vrEmuTms9918VramImageNew
+ * --------------------
+ * create a shareable image of the current vram of tms9918
+ * (eg. after a rom has loaded its fonts and patterns)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918VramImage* vrEmuTms9918VramImageNew(VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918VramImageDestroy
+ * --------------------
+ * destroy a vram image. instances created from it are unaffected
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918VramImageDestroy(VrEmuTms9918VramImage* image);
+
+/* Function:  vrEmuTms9918NewShared
+ * --------------------
+ * create a new TMS9918 with vram initialized from image
+ *
+ * vram pages are shared with other instances created from the same image
+ * and copied only when written (memory pages, typically 4KB). rendering
+ * reads vram directly, as for any other instance. platforms without shared
+ * memory support receive a private copy
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918* vrEmuTms9918NewShared(VrEmuTms9918VramImage* image);
+
+/* Function:  vrEmuTms9918Clone
+ * --------------------
+ * create a new TMS9918 with a copy of the registers, vram, port latches,
+ * status and beam position of tms9918 (with private vram)
+ *
+ * the INT callback, profiler and access timing model are not copied
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918* vrEmuTms9918Clone(VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918CloneInto
+ * --------------------
+ * copy the state of src into dest (as for vrEmuTms9918Clone), keeping
+ * dest's INT callback (notified if INT changes), profiler and access
+ * timing model
+ *
+ * returns false if the vram sizes differ
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918CloneInto(VrEmuTms9918* dest, VrEmuTms9918* src);
+
+/* Function:  vrEmuTms9918ResetToTemplate
+ * --------------------
+ * restore tms9918 to the state of templ (as for vrEmuTms9918CloneInto)
+ *
+ * when tms9918 was last cloned or reset from templ and templ hasn't been
+ * written since, only the 256-byte vram blocks tms9918 has written are
+ * copied. otherwise all of vram is copied. returns false if the vram
+ * sizes differ
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ResetToTemplate(VrEmuTms9918* tms9918, VrEmuTms9918* templ);
+
 /* Function:  vrEmuTms9918WriteAddr
  * --------------------
  * write an address (mode = 1) to the tms9918
@@ -180,6 +427,163 @@ uint8_t vrEmuTms9918ReadDataNoInc(VrEmuTms9918* tms9918);
 VR_EMU_TMS9918_DLLEXPORT
 void vrEmuTms9918ScanLine(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X]);
 
+/* Function:  vrEmuTms9918BackgroundScanLine
+ * ----------------------------------------
+ * generate the background (tiles or backdrop) of a scanline without
+ * sprites. no side effects on the status register
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918BackgroundScanLine(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X]);
+
+/* Function:  vrEmuTms9918SpriteScanLine
+ * ----------------------------------------
+ * evaluate the sprites of a scanline, drawing them over pixels. only
+ * sprite pixels are written (never TMS_TRANSPARENT), so pixels filled
+ * with TMS_TRANSPARENT beforehand become a sprite layer. the status
+ * register and INT are updated as for vrEmuTms9918ScanLine, which is
+ * vrEmuTms9918BackgroundScanLine followed by this
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SpriteScanLine(VrEmuTms9918* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X]);
+
+/* Function:  vrEmuTms9918ScanRow
+ * ----------------------------------------
+ * generate the TMS9918_ROW_LINES scanlines of a character row (0 - 23)
+ * for frame-level rendering. each name and color entry is fetched once
+ * per row rather than per line. sprites are still composited per line.
+ * results (pixels, status, INT) are identical to vrEmuTms9918ScanLine
+ * for each line in turn
+ *
+ * pixels: TMS9918_ROW_LINES lines of TMS9918_PIXELS_X
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ScanRow(VrEmuTms9918* tms9918, uint8_t row, uint8_t pixels[TMS9918_ROW_LINES * TMS9918_PIXELS_X]);
+
+/* Function:  vrEmuTms9918ScanLineMulti
+ * ----------------------------------------
+ * generate scanline y for count instances (pixels[i] for instances[i]).
+ * graphics i/ii instances are rendered TMS_MULTI_MAX_LANES at a time in
+ * lock step, one instance per byte of an SSE2/NEON vector (plain loops
+ * elsewhere). other modes fall back to vrEmuTms9918ScanLine per instance.
+ * results are identical to vrEmuTms9918ScanLine
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ScanLineMulti(VrEmuTms9918* const* instances, unsigned int count, uint8_t y, uint8_t* const* pixels);
+
+/* Function:  vrEmuTms9918RenderThumbnail
+ * ----------------------------------------
+ * render the current frame reduced by factor (eg. 2 = 128x96, 4 = 64x48)
+ * as packed RGB888. point filtering only evaluates the pixels it needs
+ *
+ * palette: 16 RGBA colors as per vrEmuTms9918Palette
+ * rgb:     (192 / factor) rows of at least (256 / factor) * 3 bytes
+ * stride:  bytes per row
+ *
+ * doesn't affect emulated state (status, collisions, beam)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918RenderThumbnail(VrEmuTms9918* tms9918, uint8_t factor, vrEmuTms9918ThumbnailFilter filter,
+                                 const uint32_t palette[16], uint8_t* rgb, size_t stride);
+
+/* Function:  vrEmuTms9918RunCycles
+ * ----------------------------------------
+ * advance the beam by the given number of cycles
+ *
+ * each visible line completed is rendered with vrEmuTms9918ScanLine(), into
+ * frameBuffer (TMS9918_PIXELS_X * TMS9918_PIXELS_Y) if provided. INT is
+ * raised when line 191 completes. this allows a cpu core to run until
+ * vrEmuTms9918CyclesToInterrupt() rather than syncing every scanline
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918RunCycles(VrEmuTms9918* tms9918, uint32_t cycles, uint8_t* frameBuffer);
+
+/* Function:  vrEmuTms9918RunFrame
+ * ----------------------------------------
+ * run to the end of the current frame (beam back at line 0)
+ *
+ * visible lines are rendered into frameBuffer and delivered to blockFn in
+ * blocks of up to linesPerBlock lines as soon as they're complete. the
+ * last block of the frame may be shorter
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918RunFrame(VrEmuTms9918* tms9918, uint8_t* frameBuffer, uint8_t linesPerBlock,
+                          vrEmuTms9918LineBlockFn blockFn, void* userData);
+
+/* Function:  vrEmuTms9918CyclesToInterrupt
+ * ----------------------------------------
+ * cycles until the next end of active display (when INT is raised if
+ * enabled). port writes may enable or disable INT in the meantime
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint32_t vrEmuTms9918CyclesToInterrupt(VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918BeamLine
+ * ----------------------------------------
+ * current beam line (0 to lines per frame - 1)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint16_t vrEmuTms9918BeamLine(VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918SetLinesPerFrame
+ * ----------------------------------------
+ * set the total lines per frame (default TMS9918_LINES_PER_FRAME_NTSC)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetLinesPerFrame(VrEmuTms9918* tms9918, uint16_t lines);
+
+/* Function:  vrEmuTms9918InterruptActive
+ * ----------------------------------------
+ * current state of the INT output
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918InterruptActive(VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918SetInterruptCallback
+ * ----------------------------------------
+ * set a callback for INT output changes (raised by rendering line 191,
+ * cleared by reading status, masked / unmasked by register 1)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetInterruptCallback(VrEmuTms9918* tms9918, vrEmuTms9918IntFn intFn, void* userData);
+
+/* Function:  vrEmuTms9918SetProfile
+ * ----------------------------------------
+ * count vram accesses per 64 byte block into profile (NULL to stop).
+ * counters accumulate until the caller clears them
+ *
+ * returns false if built without VR_EMU_TMS9918_PROFILE, in which case
+ * the hooks compile away entirely
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918SetProfile(VrEmuTms9918* tms9918, vrEmuTms9918Profile* profile);
+
+/* Function:  vrEmuTms9918SetAccessTiming
+ * ----------------------------------------
+ * check cpu vram accesses against the mode dependent access windows of
+ * the hardware (NULL to stop). the beam position is the time of each
+ * access, so advance it with vrEmuTms9918RunCycles() up to each port
+ * access. the active display is lines 0 - 191 (horizontal blanking is
+ * not modelled). statistics accumulate until the caller clears them
+ *
+ * TMS_ACCESS_DELAY doesn't advance time. the access is modelled as
+ * happening lastDelay cycles late, so the host must stall its cpu by
+ * lastDelay and include them in its next vrEmuTms9918RunCycles()
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetAccessTiming(VrEmuTms9918* tms9918, vrEmuTms9918AccessTiming* timing);
+
+/* Function:  vrEmuTms9918SetAccessCycle
+ * ----------------------------------------
+ * time the following cpu vram accesses at cycle rather than at the beam
+ * position. for hosts that run the vdp in batches but know the cycle of
+ * each port access. cycles are counted from when the access timing model
+ * was set (cycle 0 is the beam position at that time). cycles before the
+ * current frame are ignored. the beam position is used again once
+ * vrEmuTms9918RunCycles() or vrEmuTms9918RunFrame() advances it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetAccessCycle(VrEmuTms9918* tms9918, uint64_t cycle);
+
 /* Function:  vrEmuTms9918RegValue
  * ----------------------------------------
  * return a reigister value
@@ -202,6 +606,67 @@ void vrEmuTms9918WriteRegValue(VrEmuTms9918* tms9918, vrEmuTms9918Register reg,
 VR_EMU_TMS9918_DLLEXPORT
 uint8_t vrEmuTms9918VramValue(VrEmuTms9918* tms9918, uint16_t addr);
 
+/* Function:  vrEmuTms9918ReadVram
+ * ----------------------------------------
+ * copy a block of vram (wraps at the end of vram)
+ * does not affect the address pointer or read-ahead buffer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ReadVram(VrEmuTms9918* tms9918, uint16_t addr, uint8_t* dest, size_t numBytes);
+
+/* Function:  vrEmuTms9918WriteVram
+ * ----------------------------------------
+ * bulk write a block of vram (wraps at the end of vram)
+ * does not affect the address pointer or read-ahead buffer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918WriteVram(VrEmuTms9918* tms9918, uint16_t addr, const uint8_t* src, size_t numBytes);
+
+/* Function:  vrEmuTms9918GetPortState
+ * ----------------------------------------
+ * get the cpu port latch state
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918GetPortState(VrEmuTms9918* tms9918, vrEmuTms9918PortState* state);
+
+/* Function:  vrEmuTms9918SetPortState
+ * ----------------------------------------
+ * restore the cpu port latch state. the INT callback is notified if the
+ * restored status changes the INT output
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918SetPortState(VrEmuTms9918* tms9918, const vrEmuTms9918PortState* state);
+
+/* Function:  vrEmuTms9918WriteEpoch
+ * ----------------------------------------
+ * counter incremented by each register or vram write. observers can
+ * poll it to skip snapshots when nothing has changed
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint32_t vrEmuTms9918WriteEpoch(VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918TrySnapshot
+ * ----------------------------------------
+ * copy a consistent view of the registers and vram from another thread
+ * without blocking the emulation thread (seqlock read)
+ *
+ * registers: TMS_NUM_REGISTERS bytes (or NULL)
+ * vram:      vrEmuTms9918GetVramSize() bytes (or NULL)
+ *
+ * never retries. returns false if a write was in progress or raced the
+ * copy, in which case the copied contents may be torn
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918TrySnapshot(VrEmuTms9918* tms9918, uint8_t registers[TMS_NUM_REGISTERS], uint8_t* vram);
+
+/* Function:  vrEmuTms9918Snapshot
+ * ----------------------------------------
+ * vrEmuTms9918TrySnapshot, retrying up to maxAttempts times
+ * (0 = until successful)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918Snapshot(VrEmuTms9918* tms9918, uint8_t registers[TMS_NUM_REGISTERS], uint8_t* vram, unsigned int maxAttempts);
+
 
 /* Function:  vrEmuTms9918DisplayEnabled
   * --------------------
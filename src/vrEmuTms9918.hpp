@@ -0,0 +1,391 @@
+/*
+ * Troy's TMS9918 Emulator - C++17 interface
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_HPP_
+#define _VR_EMU_TMS9918_HPP_
+
+/* ------------------------------------------------------------------
+ * header only C++17 wrapper around the C interface
+ *
+ *   vrEmu::Tms9918      move-only owner of a VrEmuTms9918 instance
+ *   vrEmu::Span<T>      std::span when compiled as C++20, otherwise a
+ *                       minimal stand-in with the same interface subset
+ *   vrEmu::Indexed,     output pixel formats for Tms9918::render()
+ *   vrEmu::Rgba8888,
+ *   vrEmu::Rgb888,
+ *   vrEmu::Rgb565
+ *
+ * allocation failure throws std::bad_alloc. undersized buffers throw
+ * std::length_error
+ */
+
+#include "vrEmuTms9918.h"
+#include "vrEmuTms9918Util.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#define VR_EMU_TMS9918_STD_SPAN 1
+#endif
+#endif
+
+namespace vrEmu
+{
+
+#if VR_EMU_TMS9918_STD_SPAN
+
+template <typename T>
+using Span = std::span<T>;
+
+#else
+
+/* Class:  Span
+ * ----------------------------------------
+ * non-owning view of a contiguous sequence (subset of std::span<T>)
+ */
+template <typename T>
+class Span
+{
+public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using size_type = std::size_t;
+  using pointer = T*;
+  using reference = T&;
+  using iterator = T*;
+
+  constexpr Span() noexcept = default;
+  constexpr Span(T* data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+  template <std::size_t N>
+  constexpr Span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+
+  /* any container with data() and size(), eg. std::vector, std::array */
+  template <typename Container,
+            typename = std::enable_if_t<!std::is_array_v<std::remove_reference_t<Container>> &&
+                                        std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>>
+  constexpr Span(Container& container) noexcept : data_(container.data()), size_(container.size()) {}
+
+  /* Span<U> to Span<const U> */
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+  constexpr Span(const Span<U>& other) noexcept : data_(other.data()), size_(other.size()) {}
+
+  constexpr T* data() const noexcept { return data_; }
+  constexpr std::size_t size() const noexcept { return size_; }
+  constexpr std::size_t size_bytes() const noexcept { return size_ * sizeof(T); }
+  constexpr bool empty() const noexcept { return size_ == 0; }
+
+  constexpr T& operator[](std::size_t index) const noexcept { return data_[index]; }
+  constexpr T* begin() const noexcept { return data_; }
+  constexpr T* end() const noexcept { return data_ + size_; }
+
+  constexpr Span first(std::size_t count) const noexcept { return Span(data_, count); }
+  constexpr Span subspan(std::size_t offset, std::size_t count) const noexcept { return Span(data_ + offset, count); }
+  constexpr Span subspan(std::size_t offset) const noexcept { return Span(data_ + offset, size_ - offset); }
+
+private:
+  T* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+#endif
+
+
+/* PIXEL FORMATS
+ * ----------------------------------------
+ * each format defines its pixel Type and a constexpr conversion from a
+ * palette entry (index and vrEmuTms9918Palette RGBA value)
+ */
+
+/* palette index (vrEmuTms9918Color) */
+struct Indexed
+{
+  using Type = uint8_t;
+  static constexpr Type fromPalette(uint8_t index, uint32_t) noexcept { return index; }
+};
+
+/* vrEmuTms9918Palette value (0xRRGGBBAA) */
+struct Rgba8888
+{
+  using Type = uint32_t;
+  static constexpr Type fromPalette(uint8_t, uint32_t rgba) noexcept { return rgba; }
+};
+
+/* packed r, g, b bytes */
+struct Rgb888
+{
+  struct Type
+  {
+    uint8_t r, g, b;
+  };
+  static constexpr Type fromPalette(uint8_t, uint32_t rgba) noexcept
+  {
+    return Type{ (uint8_t)(rgba >> 24), (uint8_t)(rgba >> 16), (uint8_t)(rgba >> 8) };
+  }
+};
+static_assert(sizeof(Rgb888::Type) == 3, "Rgb888 pixels must be packed");
+
+/* 5:6:5 */
+struct Rgb565
+{
+  using Type = uint16_t;
+  static constexpr Type fromPalette(uint8_t, uint32_t rgba) noexcept
+  {
+    return (Type)(((rgba >> 16) & 0xf800) | ((rgba >> 13) & 0x07e0) | ((rgba >> 11) & 0x001f));
+  }
+};
+
+static_assert(Rgb565::fromPalette(0, 0xffffffff) == 0xffff, "Rgb565 conversion");
+static_assert(Rgb565::fromPalette(0, 0xff0000ff) == 0xf800, "Rgb565 conversion");
+static_assert(Rgb565::fromPalette(0, 0x00ff00ff) == 0x07e0, "Rgb565 conversion");
+static_assert(Rgb565::fromPalette(0, 0x0000ffff) == 0x001f, "Rgb565 conversion");
+
+
+/* Class:  Tms9918
+ * ----------------------------------------
+ * owns a VrEmuTms9918 instance. movable, not copyable
+ */
+class Tms9918
+{
+public:
+  static constexpr std::size_t Width = TMS9918_PIXELS_X;
+  static constexpr std::size_t Height = TMS9918_PIXELS_Y;
+
+  explicit Tms9918(vrEmuTms9918VramSize vramSize = TMS_VRAM_16K)
+    : tms9918_(vrEmuTms9918NewWithVram(vramSize))
+  {
+    if (tms9918_ == nullptr)
+      throw std::bad_alloc();
+  }
+
+  /* take ownership of an existing instance (eg. from vrEmuTms9918NewShared) */
+  static Tms9918 adopt(VrEmuTms9918* tms9918)
+  {
+    if (tms9918 == nullptr)
+      throw std::invalid_argument("vrEmu::Tms9918::adopt: null instance");
+    return Tms9918(tms9918, AdoptTag{});
+  }
+
+  ~Tms9918() { vrEmuTms9918Destroy(tms9918_); }
+
+  Tms9918(const Tms9918&) = delete;
+  Tms9918& operator=(const Tms9918&) = delete;
+
+  Tms9918(Tms9918&& other) noexcept : tms9918_(std::exchange(other.tms9918_, nullptr)) {}
+  Tms9918& operator=(Tms9918&& other) noexcept
+  {
+    std::swap(tms9918_, other.tms9918_);
+    return *this;
+  }
+
+  /* underlying instance for the rest of the C interface.
+   * null only after being moved from */
+  VrEmuTms9918* get() const noexcept { return tms9918_; }
+  explicit operator bool() const noexcept { return tms9918_ != nullptr; }
+
+  /* give up ownership */
+  VrEmuTms9918* release() noexcept { return std::exchange(tms9918_, nullptr); }
+
+  void reset() noexcept { vrEmuTms9918Reset(tms9918_); }
+
+  /* independent copy (see vrEmuTms9918Clone) */
+  Tms9918 clone() const
+  {
+    VrEmuTms9918* copy = vrEmuTms9918Clone(tms9918_);
+    if (copy == nullptr)
+      throw std::bad_alloc();
+    return Tms9918(copy, AdoptTag{});
+  }
+
+  /* become a copy of other. resetTo only copies diverged vram when this
+   * was last copied from an unchanged other (see vrEmuTms9918ResetToTemplate) */
+  void cloneFrom(const Tms9918& other)
+  {
+    if (!vrEmuTms9918CloneInto(tms9918_, other.tms9918_))
+      throw std::invalid_argument("vrEmu::Tms9918::cloneFrom: vram size mismatch");
+  }
+
+  void resetTo(const Tms9918& templ)
+  {
+    if (!vrEmuTms9918ResetToTemplate(tms9918_, templ.tms9918_))
+      throw std::invalid_argument("vrEmu::Tms9918::resetTo: vram size mismatch");
+  }
+
+  /* cpu ports */
+  void writeAddr(uint8_t data) noexcept { vrEmuTms9918WriteAddr(tms9918_, data); }
+  void writeData(uint8_t data) noexcept { vrEmuTms9918WriteData(tms9918_, data); }
+  uint8_t readStatus() noexcept { return vrEmuTms9918ReadStatus(tms9918_); }
+  uint8_t readData() noexcept { return vrEmuTms9918ReadData(tms9918_); }
+  uint8_t readDataNoInc() noexcept { return vrEmuTms9918ReadDataNoInc(tms9918_); }
+
+  /* one port access per element (eg. a recorded or scripted port stream) */
+  void writeAddr(Span<const uint8_t> data) noexcept
+  {
+    for (const uint8_t value : data) vrEmuTms9918WriteAddr(tms9918_, value);
+  }
+  void writeData(Span<const uint8_t> data) noexcept
+  {
+    for (const uint8_t value : data) vrEmuTms9918WriteData(tms9918_, value);
+  }
+  void readStatus(Span<uint8_t> dest) noexcept
+  {
+    for (uint8_t& value : dest) value = vrEmuTms9918ReadStatus(tms9918_);
+  }
+  void readData(Span<uint8_t> dest) noexcept
+  {
+    for (uint8_t& value : dest) value = vrEmuTms9918ReadData(tms9918_);
+  }
+
+  /* registers */
+  uint8_t regValue(vrEmuTms9918Register reg) const noexcept { return vrEmuTms9918RegValue(tms9918_, reg); }
+  void writeRegValue(vrEmuTms9918Register reg, uint8_t value) noexcept { vrEmuTms9918WriteRegValue(tms9918_, reg, value); }
+
+  /* registers 0 .. values.size() - 1 (at most TMS_NUM_REGISTERS) */
+  void writeRegisters(Span<const uint8_t> values) noexcept
+  {
+    const std::size_t count = std::min<std::size_t>(values.size(), TMS_NUM_REGISTERS);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      vrEmuTms9918WriteRegValue(tms9918_, (vrEmuTms9918Register)i, values[i]);
+    }
+  }
+
+  bool displayEnabled() const noexcept { return vrEmuTms9918DisplayEnabled(tms9918_); }
+  vrEmuTms9918Mode displayMode() const noexcept { return vrEmuTms9918DisplayMode(tms9918_); }
+
+  /* vram (addresses wrap. doesn't affect the address pointer) */
+  std::size_t vramSize() const noexcept { return (std::size_t)vrEmuTms9918GetVramSize(tms9918_); }
+  uint8_t vramValue(uint16_t addr) const noexcept { return vrEmuTms9918VramValue(tms9918_, addr); }
+  void readVram(uint16_t addr, Span<uint8_t> dest) const noexcept
+  {
+    vrEmuTms9918ReadVram(tms9918_, addr, dest.data(), dest.size());
+  }
+  void writeVram(uint16_t addr, Span<const uint8_t> src) noexcept
+  {
+    vrEmuTms9918WriteVram(tms9918_, addr, src.data(), src.size());
+  }
+
+  /* generate scanline y (palette indexes) */
+  void scanLine(uint8_t y, Span<uint8_t> pixels)
+  {
+    requireSize(pixels.size(), Width);
+    vrEmuTms9918ScanLine(tms9918_, y, pixels.data());
+  }
+
+  /* run to the end of the current frame (see vrEmuTms9918RunFrame),
+   * rendering the visible lines into frame (palette indexes) */
+  void runFrame(Span<uint8_t> frame)
+  {
+    requireSize(frame.size(), Width * Height);
+    vrEmuTms9918RunFrame(tms9918_, frame.data(), (uint8_t)Height, nullptr, nullptr);
+  }
+
+  /* Function:  render
+   * ----------------------------------------
+   * render a frame in the given pixel Format, each pixel repeated Scale
+   * times in both directions. rows are Stride pixels apart (compile time
+   * stride) or stride pixels apart (run time stride)
+   *
+   * like vrEmuTms9918ScanLine(), this updates the status register
+   */
+  template <typename Format, unsigned Scale = 1, std::size_t Stride = Width * Scale>
+  void render(Span<typename Format::Type> out)
+  {
+    static_assert(Stride >= Width * Scale, "stride must cover a scaled row");
+    requireSize(out.size(), frameSize<Scale>(Stride));
+    renderFrame<Format, Scale>(out.data(), Stride);
+  }
+
+  template <typename Format, unsigned Scale = 1>
+  void render(Span<typename Format::Type> out, std::size_t stride)
+  {
+    if (stride < Width * Scale)
+      throw std::invalid_argument("vrEmu::Tms9918::render: stride must cover a scaled row");
+    requireSize(out.size(), frameSize<Scale>(stride));
+    renderFrame<Format, Scale>(out.data(), stride);
+  }
+
+  /* pixels required to render at Scale with the given stride */
+  template <unsigned Scale = 1>
+  static constexpr std::size_t frameSize(std::size_t stride = Width * Scale) noexcept
+  {
+    return (Height * Scale - 1) * stride + Width * Scale;
+  }
+
+private:
+  struct AdoptTag {};
+  Tms9918(VrEmuTms9918* tms9918, AdoptTag) noexcept : tms9918_(tms9918) {}
+
+  static void requireSize(std::size_t size, std::size_t required)
+  {
+    if (size < required)
+      throw std::length_error("vrEmu::Tms9918: output buffer too small");
+  }
+
+  template <typename Format, unsigned Scale>
+  void renderFrame(typename Format::Type* out, std::size_t stride)
+  {
+    static_assert(Scale >= 1, "scale must be at least 1");
+    using Pixel = typename Format::Type;
+    constexpr std::size_t rowPixels = Width * Scale;
+
+    Pixel lut[16];
+    for (uint8_t i = 0; i < 16; ++i)
+    {
+      lut[i] = Format::fromPalette(i, vrEmuTms9918Palette[i]);
+    }
+
+    uint8_t line[Width];
+    for (std::size_t y = 0; y < Height; ++y)
+    {
+      Pixel* row = out + y * Scale * stride;
+
+      if constexpr (std::is_same_v<Format, Indexed> && Scale == 1)
+      {
+        /* scanline output is already the final pixels */
+        vrEmuTms9918ScanLine(tms9918_, (uint8_t)y, row);
+      }
+      else
+      {
+        vrEmuTms9918ScanLine(tms9918_, (uint8_t)y, line);
+
+        Pixel* dest = row;
+        for (std::size_t x = 0; x < Width; ++x)
+        {
+          const Pixel pixel = lut[line[x] & 0x0f];
+          for (unsigned s = 0; s < Scale; ++s)
+          {
+            *dest++ = pixel;
+          }
+        }
+
+        for (unsigned s = 1; s < Scale; ++s)
+        {
+          std::copy(row, row + rowPixels, row + s * stride);
+        }
+      }
+    }
+  }
+
+  VrEmuTms9918* tms9918_ = nullptr;
+};
+
+} // namespace vrEmu
+
+#endif // _VR_EMU_TMS9918_HPP_
@@ -0,0 +1,467 @@
+/*
+ * Troy's TMS9918 Emulator - Tile and sprite atlas export
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#include "vrEmuTms9918Atlas.h"
+#include "vrEmuTms9918Util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#undef VR_EMU_TMS9918_DLLEXPORT
+#define VR_EMU_TMS9918_DLLEXPORT
+#endif
+
+#define PATTERN_BYTES              8
+#define GFXI_COLOR_GROUP_SIZE      8
+#define GRAPHICS_NUM_COLS         32
+#define TEXT_NUM_COLS             40
+#define TILES_PER_PAGE           256
+
+#define SPRITE_ATTR_BYTES          4
+#define LAST_SPRITE_YPOS        0xD0
+#define MAX_SCANLINE_SPRITES       4
+
+/* per-tile source bytes: 8 pattern rows, then 8 row color bytes */
+#define ATLAS_SOURCE_BYTES        16
+
+ /* PRIVATE DATA STRUCTURES
+  * ---------------------- */
+struct vrEmuTms9918Atlas_s
+{
+  vrEmuTms9918AtlasKind kind;
+  vrEmuTms9918AtlasFormat format;
+  uint16_t tileCount;
+
+  /* state the cached tiles were decoded with */
+  bool valid;
+  vrEmuTms9918Mode mode;
+  uint8_t fgBgColor;
+
+  uint64_t changed[TMS_ATLAS_MAX_TILES / 64];
+  uint8_t source[TMS_ATLAS_MAX_TILES][ATLAS_SOURCE_BYTES];
+  uint8_t vram[TMS_VRAM_16K];
+
+  void* pixels;
+};
+
+/* vram table addresses (as used by the renderer) */
+typedef struct
+{
+  uint16_t mask;
+  uint16_t name;
+  uint16_t color;
+  uint16_t pattern;
+  uint16_t spriteAttr;
+  uint16_t spritePattern;
+} vrEmuTms9918AtlasTables;
+
+
+/* Function:  atlasTables
+ * ----------------------------------------
+ * decode table base addresses from the registers
+ */
+static void atlasTables(VrEmuTms9918* tms9918, vrEmuTms9918AtlasTables* tables)
+{
+  const bool gfxII = vrEmuTms9918DisplayMode(tms9918) == TMS_MODE_GRAPHICS_II;
+
+  tables->mask = (uint16_t)(vrEmuTms9918GetVramSize(tms9918) - 1);
+  tables->name = ((vrEmuTms9918RegValue(tms9918, TMS_REG_NAME_TABLE) & 0x0f) << 10) & tables->mask;
+  tables->color = ((vrEmuTms9918RegValue(tms9918, TMS_REG_COLOR_TABLE) & (gfxII ? 0x80 : 0xff)) << 6) & tables->mask;
+  tables->pattern = ((vrEmuTms9918RegValue(tms9918, TMS_REG_PATTERN_TABLE) & (gfxII ? 0x04 : 0x07)) << 11) & tables->mask;
+  tables->spriteAttr = ((vrEmuTms9918RegValue(tms9918, TMS_REG_SPRITE_ATTR_TABLE) & 0x7f) << 7) & tables->mask;
+  tables->spritePattern = ((vrEmuTms9918RegValue(tms9918, TMS_REG_SPRITE_PATT_TABLE) & 0x07) << 11) & tables->mask;
+}
+
+/* Function:  atlasTileCount
+ * ----------------------------------------
+ * number of tiles for the given atlas kind and mode
+ */
+static uint16_t atlasTileCount(vrEmuTms9918AtlasKind kind, vrEmuTms9918Mode mode)
+{
+  if (kind == TMS_ATLAS_SPRITES)
+    return TILES_PER_PAGE;
+
+  switch (mode)
+  {
+    case TMS_MODE_GRAPHICS_II:
+      return TILES_PER_PAGE * 3;
+
+    case TMS_MODE_MULTICOLOR:
+      return TILES_PER_PAGE * 4;
+
+    default:
+      return TILES_PER_PAGE;
+  }
+}
+
+/* Function:  atlasTileSource
+ * ----------------------------------------
+ * gather the source bytes a tile is decoded from
+ */
+static void atlasTileSource(VrEmuTms9918Atlas* atlas, VrEmuTms9918* tms9918, const vrEmuTms9918AtlasTables* tables,
+                            uint16_t tile, uint8_t src[ATLAS_SOURCE_BYTES])
+{
+  const uint8_t* vram = atlas->vram;
+  const uint16_t mask = tables->mask;
+  const uint8_t name = tile & 0xff;
+  const uint16_t page = tile >> 8;
+
+  if (atlas->kind == TMS_ATLAS_SPRITES)
+  {
+    for (int row = 0; row < PATTERN_BYTES; ++row)
+    {
+      src[row] = vram[(tables->spritePattern + name * PATTERN_BYTES + row) & mask];
+    }
+    memset(src + PATTERN_BYTES, 0, PATTERN_BYTES);
+    return;
+  }
+
+  switch (atlas->mode)
+  {
+    case TMS_MODE_GRAPHICS_I:
+      for (int row = 0; row < PATTERN_BYTES; ++row)
+      {
+        src[row] = vram[(tables->pattern + name * PATTERN_BYTES + row) & mask];
+      }
+      memset(src + PATTERN_BYTES, vram[(tables->color + name / GFXI_COLOR_GROUP_SIZE) & mask], PATTERN_BYTES);
+      break;
+
+    case TMS_MODE_GRAPHICS_II:
+    {
+      /* page mirroring as per vrEmuTms9918GraphicsIIScanLine */
+      const uint8_t r3 = vrEmuTms9918RegValue(tms9918, TMS_REG_COLOR_TABLE);
+      const uint8_t r4 = vrEmuTms9918RegValue(tms9918, TMS_REG_PATTERN_TABLE);
+      const uint16_t pageOffset = (uint16_t)((page & (r4 & 0x03)) << 11);
+      const uint16_t pattBase = tables->pattern + pageOffset;
+      const uint16_t colorBase = tables->color + (pageOffset & ((r3 & 0x60) << 6));
+
+      for (int row = 0; row < PATTERN_BYTES; ++row)
+      {
+        src[row] = vram[(pattBase + name * PATTERN_BYTES + row) & mask];
+        src[PATTERN_BYTES + row] = vram[(colorBase + name * PATTERN_BYTES + row) & mask];
+      }
+      break;
+    }
+
+    case TMS_MODE_TEXT:
+      for (int row = 0; row < PATTERN_BYTES; ++row)
+      {
+        src[row] = vram[(tables->pattern + name * PATTERN_BYTES + row) & mask];
+      }
+      memset(src + PATTERN_BYTES, vrEmuTms9918RegValue(tms9918, TMS_REG_FG_BG_COLOR), PATTERN_BYTES);
+      break;
+
+    case TMS_MODE_MULTICOLOR:
+    {
+      /* two color bytes per row group. each covers 4 pixel rows */
+      const uint16_t addr = tables->pattern + name * PATTERN_BYTES + page * 2;
+      memset(src, 0xf0, PATTERN_BYTES);
+      memset(src + PATTERN_BYTES, vram[addr & mask], PATTERN_BYTES / 2);
+      memset(src + PATTERN_BYTES + PATTERN_BYTES / 2, vram[(addr + 1) & mask], PATTERN_BYTES / 2);
+      break;
+    }
+  }
+}
+
+/* Function:  atlasDecodeTile
+ * ----------------------------------------
+ * decode a tile's source bytes into the atlas pixels
+ */
+static void atlasDecodeTile(VrEmuTms9918Atlas* atlas, uint16_t tile, const uint8_t src[ATLAS_SOURCE_BYTES])
+{
+  const uint8_t backdrop = atlas->fgBgColor & 0x0f;
+  const size_t origin = (size_t)(tile / TMS_ATLAS_TILES_PER_ROW) * 8 * TMS_ATLAS_WIDTH +
+                        (size_t)(tile % TMS_ATLAS_TILES_PER_ROW) * 8;
+
+  for (int row = 0; row < PATTERN_BYTES; ++row)
+  {
+    uint8_t fg = 1, bg = 0;
+    if (atlas->kind == TMS_ATLAS_TILES)
+    {
+      fg = src[PATTERN_BYTES + row] >> 4;
+      bg = src[PATTERN_BYTES + row] & 0x0f;
+      if (fg == TMS_TRANSPARENT) fg = backdrop;
+      if (bg == TMS_TRANSPARENT) bg = backdrop;
+    }
+
+    const size_t offset = origin + (size_t)row * TMS_ATLAS_WIDTH;
+    uint8_t pattByte = src[row];
+
+    for (int bit = 0; bit < 8; ++bit, pattByte <<= 1)
+    {
+      const uint8_t index = (pattByte & 0x80) ? fg : bg;
+
+      if (atlas->format == TMS_ATLAS_INDEXED)
+      {
+        ((uint8_t*)atlas->pixels)[offset + bit] = index;
+      }
+      else if (atlas->kind == TMS_ATLAS_SPRITES)
+      {
+        ((uint32_t*)atlas->pixels)[offset + bit] = index ? 0xffffffff : 0x00000000;
+      }
+      else
+      {
+        ((uint32_t*)atlas->pixels)[offset + bit] = vrEmuTms9918Palette[index];
+      }
+    }
+  }
+}
+
+
+/* Function:  vrEmuTms9918AtlasNew
+ * ----------------------------------------
+ * create a tile or sprite atlas
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918Atlas* vrEmuTms9918AtlasNew(vrEmuTms9918AtlasKind kind, vrEmuTms9918AtlasFormat format)
+{
+  VrEmuTms9918Atlas* atlas = (VrEmuTms9918Atlas*)malloc(sizeof(VrEmuTms9918Atlas));
+  if (atlas == NULL)
+    return NULL;
+
+  const size_t pixelBytes = (format == TMS_ATLAS_RGBA) ? sizeof(uint32_t) : sizeof(uint8_t);
+
+  atlas->kind = kind;
+  atlas->format = format;
+  atlas->tileCount = atlasTileCount(kind, TMS_MODE_GRAPHICS_I);
+  atlas->valid = false;
+  atlas->mode = TMS_MODE_GRAPHICS_I;
+  atlas->fgBgColor = 0;
+  memset(atlas->changed, 0, sizeof(atlas->changed));
+  atlas->pixels = calloc((size_t)TMS_ATLAS_WIDTH * TMS_ATLAS_MAX_HEIGHT, pixelBytes);
+
+  if (atlas->pixels == NULL)
+  {
+    free(atlas);
+    return NULL;
+  }
+
+  return atlas;
+}
+
+/* Function:  vrEmuTms9918AtlasDestroy
+ * ----------------------------------------
+ * destroy an atlas
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918AtlasDestroy(VrEmuTms9918Atlas* atlas)
+{
+  if (atlas)
+  {
+    free(atlas->pixels);
+    free(atlas);
+  }
+}
+
+/* Function:  vrEmuTms9918AtlasUpdate
+ * ----------------------------------------
+ * decode changed tiles
+ */
+VR_EMU_TMS9918_DLLEXPORT
+int vrEmuTms9918AtlasUpdate(VrEmuTms9918Atlas* atlas, VrEmuTms9918* tms9918)
+{
+  if (atlas == NULL || tms9918 == NULL)
+    return 0;
+
+  vrEmuTms9918AtlasTables tables;
+  atlasTables(tms9918, &tables);
+  vrEmuTms9918ReadVram(tms9918, 0, atlas->vram, (size_t)tables.mask + 1);
+
+  const vrEmuTms9918Mode mode = vrEmuTms9918DisplayMode(tms9918);
+  const uint8_t fgBgColor = vrEmuTms9918RegValue(tms9918, TMS_REG_FG_BG_COLOR);
+
+  /* mode or backdrop changes invalidate every tile */
+  bool all = !atlas->valid;
+  if (atlas->kind == TMS_ATLAS_TILES && (mode != atlas->mode || fgBgColor != atlas->fgBgColor))
+  {
+    all = true;
+  }
+
+  atlas->valid = true;
+  atlas->mode = mode;
+  atlas->fgBgColor = fgBgColor;
+  atlas->tileCount = atlasTileCount(atlas->kind, mode);
+  memset(atlas->changed, 0, sizeof(atlas->changed));
+
+  int changed = 0;
+  uint8_t src[ATLAS_SOURCE_BYTES];
+
+  for (uint16_t tile = 0; tile < atlas->tileCount; ++tile)
+  {
+    atlasTileSource(atlas, tms9918, &tables, tile, src);
+
+    if (all || memcmp(src, atlas->source[tile], ATLAS_SOURCE_BYTES) != 0)
+    {
+      memcpy(atlas->source[tile], src, ATLAS_SOURCE_BYTES);
+      atlasDecodeTile(atlas, tile, src);
+      atlas->changed[tile >> 6] |= (uint64_t)1 << (tile & 63);
+      ++changed;
+    }
+  }
+
+  return changed;
+}
+
+/* Function:  vrEmuTms9918AtlasTileChanged
+ * ----------------------------------------
+ * did the tile change in the last update?
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918AtlasTileChanged(VrEmuTms9918Atlas* atlas, uint16_t tile)
+{
+  if (atlas == NULL || tile >= atlas->tileCount)
+    return false;
+
+  return (atlas->changed[tile >> 6] >> (tile & 63)) & 1;
+}
+
+/* Function:  vrEmuTms9918AtlasPixels
+ * ----------------------------------------
+ * atlas pixels
+ */
+VR_EMU_TMS9918_DLLEXPORT
+const void* vrEmuTms9918AtlasPixels(VrEmuTms9918Atlas* atlas)
+{
+  return atlas ? atlas->pixels : NULL;
+}
+
+/* Function:  vrEmuTms9918AtlasTileCount
+ * ----------------------------------------
+ * number of tiles in the atlas
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint16_t vrEmuTms9918AtlasTileCount(VrEmuTms9918Atlas* atlas)
+{
+  return atlas ? atlas->tileCount : 0;
+}
+
+/* Function:  vrEmuTms9918AtlasHeight
+ * ----------------------------------------
+ * atlas height in pixels
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint16_t vrEmuTms9918AtlasHeight(VrEmuTms9918Atlas* atlas)
+{
+  return atlas ? (uint16_t)(atlas->tileCount / TMS_ATLAS_TILES_PER_ROW * 8) : 0;
+}
+
+/* Function:  vrEmuTms9918AtlasTileMap
+ * ----------------------------------------
+ * build the tile map for the current display mode
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918AtlasTileMap(VrEmuTms9918* tms9918, uint16_t map[TMS_ATLAS_MAP_ROWS * TMS_ATLAS_MAP_MAX_COLS])
+{
+  if (tms9918 == NULL || map == NULL)
+    return 0;
+
+  vrEmuTms9918AtlasTables tables;
+  atlasTables(tms9918, &tables);
+
+  const vrEmuTms9918Mode mode = vrEmuTms9918DisplayMode(tms9918);
+  const uint8_t cols = (mode == TMS_MODE_TEXT) ? TEXT_NUM_COLS : GRAPHICS_NUM_COLS;
+
+  /* see vrEmuTms9918GraphicsIIScanLine */
+  const uint8_t nameMask = (mode == TMS_MODE_GRAPHICS_II)
+    ? (uint8_t)(((vrEmuTms9918RegValue(tms9918, TMS_REG_COLOR_TABLE) & 0x7f) << 3) | 0x07)
+    : 0xff;
+
+  for (uint8_t row = 0; row < TMS_ATLAS_MAP_ROWS; ++row)
+  {
+    uint16_t page = 0;
+    if (mode == TMS_MODE_GRAPHICS_II)
+    {
+      page = row >> 3;
+    }
+    else if (mode == TMS_MODE_MULTICOLOR)
+    {
+      page = row & 0x03;
+    }
+
+    for (uint8_t col = 0; col < cols; ++col)
+    {
+      const uint8_t name = vrEmuTms9918VramValue(tms9918, (uint16_t)(tables.name + row * cols + col));
+      map[row * cols + col] = (uint16_t)(page * TILES_PER_PAGE + (name & nameMask));
+    }
+  }
+
+  return cols;
+}
+
+/* Function:  vrEmuTms9918AtlasSprites
+ * ----------------------------------------
+ * decode the sprite attribute table
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918AtlasSprites(VrEmuTms9918* tms9918, vrEmuTms9918AtlasSprite sprites[TMS_ATLAS_MAX_SPRITES])
+{
+  if (tms9918 == NULL || sprites == NULL || !vrEmuTms9918DisplayEnabled(tms9918) ||
+      vrEmuTms9918DisplayMode(tms9918) == TMS_MODE_TEXT)
+    return 0;
+
+  vrEmuTms9918AtlasTables tables;
+  atlasTables(tms9918, &tables);
+
+  const uint8_t r1 = vrEmuTms9918RegValue(tms9918, TMS_REG_1);
+  const bool magnified = r1 & TMS_R1_SPRITE_MAG2;
+  const uint8_t sizePx = (uint8_t)(((r1 & TMS_R1_SPRITE_16) ? 16 : 8) << magnified);
+
+  /* sprites drawn on each line so far */
+  uint8_t lineSprites[TMS9918_PIXELS_Y];
+  memset(lineSprites, 0, sizeof(lineSprites));
+
+  uint8_t count = 0;
+  for (; count < TMS_ATLAS_MAX_SPRITES; ++count)
+  {
+    uint8_t attr[SPRITE_ATTR_BYTES];
+    vrEmuTms9918ReadVram(tms9918, (uint16_t)(tables.spriteAttr + count * SPRITE_ATTR_BYTES), attr, SPRITE_ATTR_BYTES);
+
+    if (attr[0] == LAST_SPRITE_YPOS)
+      break;
+
+    /* as per vrEmuTms9918OutputSprites */
+    int16_t y = attr[0];
+    if (y > 0xe0)
+    {
+      y -= 256;
+    }
+
+    vrEmuTms9918AtlasSprite* sprite = &sprites[count];
+    sprite->index = count;
+    sprite->earlyClock = attr[3] & 0x80;
+    sprite->y = y + 1;
+    sprite->x = (int16_t)(attr[1] - (sprite->earlyClock ? 32 : 0));
+    sprite->pattern = attr[2];
+    sprite->color = (vrEmuTms9918Color)(attr[3] & 0x0f);
+    sprite->sizePx = sizePx;
+    sprite->magnified = magnified;
+    sprite->hiddenLines = 0;
+
+    for (int line = sprite->y; line < sprite->y + sizePx; ++line)
+    {
+      if (line < 0 || line >= TMS9918_PIXELS_Y)
+        continue;
+
+      /* the line stops at the 5th sprite, so every later sprite is hidden too */
+      if (lineSprites[line] >= MAX_SCANLINE_SPRITES)
+      {
+        ++sprite->hiddenLines;
+      }
+      else
+      {
+        ++lineSprites[line];
+      }
+    }
+  }
+
+  return count;
+}
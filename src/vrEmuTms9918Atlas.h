@@ -0,0 +1,159 @@
+/*
+ * Troy's TMS9918 Emulator - Tile and sprite atlas export
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_ATLAS_H_
+#define _VR_EMU_TMS9918_ATLAS_H_
+
+#include "vrEmuTms9918.h"
+
+/* ------------------------------------------------------------------
+ * ATLAS LAYOUT
+ *
+ * atlases are TMS_ATLAS_WIDTH pixels wide, with 8x8 tiles arranged in
+ * rows of TMS_ATLAS_TILES_PER_ROW. tile n is at column (n % 32), row (n / 32)
+ *
+ * tile atlas (per display mode):
+ *   graphics i:   256 tiles. pattern + color group
+ *   graphics ii:  768 tiles. 256 per screen third (tile = third * 256 + name)
+ *   text:         256 tiles. only the left 6 columns are displayed
+ *   multicolor:  1024 tiles. 256 per row group (tile = (row % 4) * 256 + name)
+ *
+ * tile colors are resolved the same way the renderer does (transparent
+ * becomes the backdrop color), so a tile map drawn from the atlas matches
+ * vrEmuTms9918ScanLine() output before sprites.
+ *
+ * sprite atlas: 256 8x8 sprite patterns. pixels are coverage rather than
+ * colors (indexed: 1 = set, 0 = clear. rgba: opaque white or transparent).
+ * 16x16 sprites are made of patterns name, name + 1 (below),
+ * name + 2 (right) and name + 3 (below right)
+ */
+
+#define TMS_ATLAS_WIDTH           256
+#define TMS_ATLAS_TILES_PER_ROW    32
+#define TMS_ATLAS_MAX_TILES      1024
+#define TMS_ATLAS_MAX_HEIGHT     ((TMS_ATLAS_MAX_TILES / TMS_ATLAS_TILES_PER_ROW) * 8)
+
+#define TMS_ATLAS_MAP_ROWS         24
+#define TMS_ATLAS_MAP_MAX_COLS     40
+
+#define TMS_ATLAS_MAX_SPRITES      32
+
+/* PRIVATE DATA STRUCTURES
+ * ---------------------------------------- */
+struct vrEmuTms9918Atlas_s;
+typedef struct vrEmuTms9918Atlas_s VrEmuTms9918Atlas;
+
+typedef enum
+{
+  TMS_ATLAS_TILES,
+  TMS_ATLAS_SPRITES,
+} vrEmuTms9918AtlasKind;
+
+typedef enum
+{
+  TMS_ATLAS_INDEXED,    /* uint8_t palette index per pixel */
+  TMS_ATLAS_RGBA,       /* uint32_t vrEmuTms9918Palette value per pixel */
+} vrEmuTms9918AtlasFormat;
+
+/* a displayed sprite (see vrEmuTms9918AtlasSprites) */
+typedef struct
+{
+  uint8_t index;        /* sprite attribute table index. lower indexes are on top */
+  int16_t x;            /* screen position of the top-left pixel */
+  int16_t y;            /* (early clock and y wrap applied) */
+  uint8_t pattern;      /* sprite pattern name. sprite atlas tile of the top-left pattern */
+  vrEmuTms9918Color color;
+  uint8_t sizePx;       /* 8, 16 or 32 (including magnification) */
+  bool magnified;
+  bool earlyClock;      /* shifted 32 pixels left */
+  uint8_t hiddenLines;  /* visible lines not drawn due to the 4 sprites per line limit */
+} vrEmuTms9918AtlasSprite;
+
+
+/* PUBLIC INTERFACE
+ * ---------------------------------------- */
+
+/* Function:  vrEmuTms9918AtlasNew
+ * --------------------
+ * create a tile or sprite atlas
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918Atlas* vrEmuTms9918AtlasNew(vrEmuTms9918AtlasKind kind, vrEmuTms9918AtlasFormat format);
+
+/* Function:  vrEmuTms9918AtlasDestroy
+ * --------------------
+ * destroy an atlas
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918AtlasDestroy(VrEmuTms9918Atlas* atlas);
+
+/* Function:  vrEmuTms9918AtlasUpdate
+ * --------------------
+ * decode the current tables of tms9918 into the atlas. only tiles whose
+ * source bytes changed since the last update are decoded
+ *
+ * returns the number of changed tiles (see vrEmuTms9918AtlasTileChanged)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+int vrEmuTms9918AtlasUpdate(VrEmuTms9918Atlas* atlas, VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918AtlasTileChanged
+ * --------------------
+ * did the tile change in the last update?
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918AtlasTileChanged(VrEmuTms9918Atlas* atlas, uint16_t tile);
+
+/* Function:  vrEmuTms9918AtlasPixels
+ * --------------------
+ * atlas pixels (TMS_ATLAS_WIDTH x vrEmuTms9918AtlasHeight). uint8_t or
+ * uint32_t per pixel depending on the format
+ */
+VR_EMU_TMS9918_DLLEXPORT
+const void* vrEmuTms9918AtlasPixels(VrEmuTms9918Atlas* atlas);
+
+/* Function:  vrEmuTms9918AtlasTileCount
+ * --------------------
+ * number of tiles in the atlas as of the last update
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint16_t vrEmuTms9918AtlasTileCount(VrEmuTms9918Atlas* atlas);
+
+/* Function:  vrEmuTms9918AtlasHeight
+ * --------------------
+ * atlas height in pixels as of the last update
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint16_t vrEmuTms9918AtlasHeight(VrEmuTms9918Atlas* atlas);
+
+/* Function:  vrEmuTms9918AtlasTileMap
+ * --------------------
+ * build the tile map for the current display mode. each entry is a tile
+ * atlas index
+ *
+ * map: TMS_ATLAS_MAP_ROWS x TMS_ATLAS_MAP_MAX_COLS entries
+ *
+ * returns the number of columns (32, or 40 in text mode). rows are packed
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918AtlasTileMap(VrEmuTms9918* tms9918, uint16_t map[TMS_ATLAS_MAP_ROWS * TMS_ATLAS_MAP_MAX_COLS]);
+
+/* Function:  vrEmuTms9918AtlasSprites
+ * --------------------
+ * decode the sprite attribute table up to the terminator (0xd0)
+ *
+ * returns the number of sprites. 0 in text mode or with the display
+ * disabled, as no sprites are drawn
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918AtlasSprites(VrEmuTms9918* tms9918, vrEmuTms9918AtlasSprite sprites[TMS_ATLAS_MAX_SPRITES]);
+
+#endif // _VR_EMU_TMS9918_ATLAS_H_
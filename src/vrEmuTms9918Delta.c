@@ -0,0 +1,172 @@
+/*
+ * Troy's TMS9918 Emulator - Frame delta encoding
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#include "vrEmuTms9918Delta.h"
+
+#include <string.h>
+
+#ifndef WIN32
+#undef VR_EMU_TMS9918_DLLEXPORT
+#define VR_EMU_TMS9918_DLLEXPORT
+#endif
+
+#define DELTA_MAX_RUN   16
+
+
+/* Function:  deltaWriteRuns
+ * ----------------------------------------
+ * run-length encode count pixels. returns the new output position or
+ * NULL if out of space
+ */
+static uint8_t* deltaWriteRuns(uint8_t* out, const uint8_t* end, const uint8_t* pixels, int count)
+{
+  int i = 0;
+  while (i < count)
+  {
+    const uint8_t color = pixels[i] & 0x0f;
+    int run = 1;
+    while (run < DELTA_MAX_RUN && i + run < count && (pixels[i + run] & 0x0f) == color)
+    {
+      ++run;
+    }
+
+    if (out == end)
+      return NULL;
+
+    *out++ = (uint8_t)(((run - 1) << 4) | color);
+    i += run;
+  }
+  return out;
+}
+
+/* Function:  vrEmuTms9918DeltaEncode
+ * ----------------------------------------
+ * encode frame relative to prevFrame (or as a key frame)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918DeltaEncode(const uint8_t* prevFrame, const uint8_t* frame, uint8_t* out, size_t outSize)
+{
+  if (frame == NULL || out == NULL || outSize < TMS_DELTA_HEADER_BYTES)
+    return 0;
+
+  const uint8_t* end = out + outSize;
+  uint8_t* p = out + TMS_DELTA_HEADER_BYTES;
+  unsigned int numSpans = 0;
+
+  for (int y = 0; y < TMS9918_PIXELS_Y; ++y)
+  {
+    const uint8_t* line = frame + y * TMS9918_PIXELS_X;
+    const uint8_t* prevLine = prevFrame ? prevFrame + y * TMS9918_PIXELS_X : NULL;
+
+    if (prevLine && memcmp(line, prevLine, TMS9918_PIXELS_X) == 0)
+      continue;
+
+    int x = 0;
+    while (x < TMS9918_PIXELS_X)
+    {
+      int last = TMS9918_PIXELS_X - 1;
+
+      if (prevLine)
+      {
+        /* first changed pixel */
+        while (x < TMS9918_PIXELS_X && line[x] == prevLine[x]) ++x;
+        if (x == TMS9918_PIXELS_X)
+          break;
+
+        /* extend the span until a long enough unchanged gap */
+        last = x;
+        for (int i = x + 1; i < TMS9918_PIXELS_X && i - last <= TMS_DELTA_MIN_GAP; ++i)
+        {
+          if (line[i] != prevLine[i]) last = i;
+        }
+      }
+
+      if (end - p < TMS_DELTA_SPAN_BYTES)
+        return 0;
+
+      *p++ = (uint8_t)y;
+      *p++ = (uint8_t)x;
+      *p++ = (uint8_t)(last - x);
+
+      p = deltaWriteRuns(p, end, line + x, last - x + 1);
+      if (p == NULL)
+        return 0;
+
+      ++numSpans;
+      x = last + 1;
+    }
+  }
+
+  out[0] = prevFrame ? TMS_DELTA_DELTA_FRAME : TMS_DELTA_KEY_FRAME;
+  out[1] = (uint8_t)(numSpans & 0xff);
+  out[2] = (uint8_t)(numSpans >> 8);
+
+  return (size_t)(p - out);
+}
+
+/* Function:  vrEmuTms9918DeltaDecode
+ * ----------------------------------------
+ * apply an encoded frame to frame
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918DeltaDecode(const uint8_t* data, size_t size, uint8_t* frame)
+{
+  if (data == NULL || frame == NULL || size < TMS_DELTA_HEADER_BYTES)
+    return 0;
+
+  if (data[0] != TMS_DELTA_KEY_FRAME && data[0] != TMS_DELTA_DELTA_FRAME)
+    return 0;
+
+  const uint8_t* end = data + size;
+  const uint8_t* p = data + TMS_DELTA_HEADER_BYTES;
+  unsigned int numSpans = data[1] | (data[2] << 8);
+
+  while (numSpans--)
+  {
+    if (end - p < TMS_DELTA_SPAN_BYTES)
+      return 0;
+
+    const uint8_t y = *p++;
+    const uint8_t x = *p++;
+    int remaining = *p++ + 1;
+
+    if (y >= TMS9918_PIXELS_Y || x + remaining > TMS9918_PIXELS_X)
+      return 0;
+
+    uint8_t* dest = frame + y * TMS9918_PIXELS_X + x;
+    while (remaining > 0)
+    {
+      if (p == end)
+        return 0;
+
+      const uint8_t token = *p++;
+      const int run = (token >> 4) + 1;
+      if (run > remaining)
+        return 0;
+
+      memset(dest, token & 0x0f, (size_t)run);
+      dest += run;
+      remaining -= run;
+    }
+  }
+
+  return (size_t)(p - data);
+}
+
+/* Function:  vrEmuTms9918DeltaIsKeyFrame
+ * ----------------------------------------
+ * is the encoded frame at data a key frame?
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918DeltaIsKeyFrame(const uint8_t* data, size_t size)
+{
+  return data && size >= TMS_DELTA_HEADER_BYTES && data[0] == TMS_DELTA_KEY_FRAME;
+}
@@ -0,0 +1,85 @@
+/*
+ * Troy's TMS9918 Emulator - Frame delta encoding
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_DELTA_H_
+#define _VR_EMU_TMS9918_DELTA_H_
+
+#include "vrEmuTms9918.h"
+
+/* ------------------------------------------------------------------
+ * FRAME RECORD FORMAT (all multi-byte values little endian)
+ *
+ * frames are TMS9918_PIXELS_X x TMS9918_PIXELS_Y palette indexes, as
+ * generated by vrEmuTms9918ScanLine(). each encoded frame is:
+ *
+ *   u8              type: 'K' key frame (no previous frame required)
+ *                         'D' delta from the previous frame
+ *   u16             number of spans
+ *   spans (in increasing y, x order):
+ *     u8            y
+ *     u8            x
+ *     u8            length - 1 (pixels)
+ *     u8[]          run-length tokens covering length pixels:
+ *                   (run length - 1) << 4 | palette index
+ *
+ * pixels outside the spans are unchanged from the previous frame. a key
+ * frame covers every pixel. an unchanged frame is 3 bytes. records are
+ * self delimiting, so a stream is simply records back to back
+ */
+
+#define TMS_DELTA_HEADER_BYTES     3
+#define TMS_DELTA_SPAN_BYTES       3
+
+/* unchanged pixels between changed pixels on a line before a new span
+ * is started rather than encoding them */
+#define TMS_DELTA_MIN_GAP          32
+
+/* worst case encoded frame size */
+#define TMS_DELTA_MAX_FRAME_BYTES  (TMS_DELTA_HEADER_BYTES + TMS9918_PIXELS_Y * (TMS_DELTA_SPAN_BYTES + TMS9918_PIXELS_X))
+
+#define TMS_DELTA_KEY_FRAME        'K'
+#define TMS_DELTA_DELTA_FRAME      'D'
+
+
+/* PUBLIC INTERFACE
+ * ---------------------------------------- */
+
+/* Function:  vrEmuTms9918DeltaEncode
+ * --------------------
+ * encode frame relative to prevFrame (or as a key frame if prevFrame is
+ * NULL)
+ *
+ * out:      at least TMS_DELTA_MAX_FRAME_BYTES to never fail
+ *
+ * returns the number of bytes written to out. 0 if outSize is too small
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918DeltaEncode(const uint8_t* prevFrame, const uint8_t* frame, uint8_t* out, size_t outSize);
+
+/* Function:  vrEmuTms9918DeltaDecode
+ * --------------------
+ * apply an encoded frame to frame, which must hold the previously decoded
+ * frame unless data is a key frame
+ *
+ * returns the number of bytes consumed. 0 if data is truncated or
+ * corrupt (frame may be partially updated)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918DeltaDecode(const uint8_t* data, size_t size, uint8_t* frame);
+
+/* Function:  vrEmuTms9918DeltaIsKeyFrame
+ * --------------------
+ * is the encoded frame at data a key frame? (for seeking in a stream)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918DeltaIsKeyFrame(const uint8_t* data, size_t size);
+
+#endif // _VR_EMU_TMS9918_DELTA_H_
@@ -0,0 +1,161 @@
+/*
+ * Troy's TMS9918 Emulator - Triple-buffered frame presentation
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#include "vrEmuTms9918FrameBuffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#undef VR_EMU_TMS9918_DLLEXPORT
+#define VR_EMU_TMS9918_DLLEXPORT
+#endif
+
+/* ready frame exchange primitives */
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FB_EXCHANGE(p, v)     ((uint32_t)_InterlockedExchange((volatile long*)(p), (long)(v)))
+#define FB_LOAD(p)            (*(volatile const uint32_t*)(p))
+#else
+#define FB_EXCHANGE(p, v)     __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define FB_LOAD(p)            __atomic_load_n((p), __ATOMIC_RELAXED)
+#endif
+
+#define FRAME_BUFFER_COUNT    3
+#define FRAME_BUFFER_INDEX    0x03
+#define FRAME_BUFFER_FRESH    0x04  /* ready frame not yet acquired */
+
+#define CACHE_LINE_BYTES      64
+
+ /* PRIVATE DATA STRUCTURES
+  * ---------------------- */
+struct vrEmuTms9918FrameBuffer_s
+{
+  vrEmuTms9918Frame frames[FRAME_BUFFER_COUNT];
+
+  /* renderer only */
+  uint32_t back;
+  uint64_t frameNumber;
+  uint8_t rendererPadding[CACHE_LINE_BYTES];
+
+  /* shared. index of the ready frame | FRAME_BUFFER_FRESH */
+  uint32_t ready;
+  uint8_t sharedPadding[CACHE_LINE_BYTES];
+
+  /* consumer only */
+  uint32_t front;
+  bool hasFront;
+};
+
+
+/* Function:  vrEmuTms9918FrameBufferNew
+ * ----------------------------------------
+ * create a triple buffer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918FrameBuffer* vrEmuTms9918FrameBufferNew(void)
+{
+  VrEmuTms9918FrameBuffer* frameBuffer = (VrEmuTms9918FrameBuffer*)malloc(sizeof(VrEmuTms9918FrameBuffer));
+  if (frameBuffer == NULL)
+    return NULL;
+
+  memset(frameBuffer, 0, sizeof(VrEmuTms9918FrameBuffer));
+  frameBuffer->back = 0;
+  frameBuffer->ready = 1;
+  frameBuffer->front = 2;
+
+  return frameBuffer;
+}
+
+/* Function:  vrEmuTms9918FrameBufferDestroy
+ * ----------------------------------------
+ * destroy a triple buffer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918FrameBufferDestroy(VrEmuTms9918FrameBuffer* frameBuffer)
+{
+  free(frameBuffer);
+}
+
+/* Function:  vrEmuTms9918FrameBufferBack
+ * ----------------------------------------
+ * the frame to render into next
+ */
+VR_EMU_TMS9918_DLLEXPORT
+vrEmuTms9918Frame* vrEmuTms9918FrameBufferBack(VrEmuTms9918FrameBuffer* frameBuffer)
+{
+  if (frameBuffer == NULL)
+    return NULL;
+
+  return &frameBuffer->frames[frameBuffer->back];
+}
+
+/* Function:  vrEmuTms9918FrameBufferPublish
+ * ----------------------------------------
+ * publish the back frame and get a new back frame
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint64_t vrEmuTms9918FrameBufferPublish(VrEmuTms9918FrameBuffer* frameBuffer, uint8_t status)
+{
+  if (frameBuffer == NULL)
+    return 0;
+
+  vrEmuTms9918Frame* frame = &frameBuffer->frames[frameBuffer->back];
+  frame->frameNumber = ++frameBuffer->frameNumber;
+  frame->status = status;
+
+  /* release the frame, take back whichever the consumer isn't holding */
+  frameBuffer->back = FB_EXCHANGE(&frameBuffer->ready, frameBuffer->back | FRAME_BUFFER_FRESH) & FRAME_BUFFER_INDEX;
+
+  return frameBuffer->frameNumber;
+}
+
+/* Function:  vrEmuTms9918FrameBufferRender
+ * ----------------------------------------
+ * render a frame into the back frame and publish it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint64_t vrEmuTms9918FrameBufferRender(VrEmuTms9918FrameBuffer* frameBuffer, VrEmuTms9918* tms9918)
+{
+  if (frameBuffer == NULL || tms9918 == NULL)
+    return 0;
+
+  uint8_t* pixels = frameBuffer->frames[frameBuffer->back].pixels;
+  for (uint8_t row = 0; row < TMS9918_ROWS; ++row)
+  {
+    vrEmuTms9918ScanRow(tms9918, row, pixels + row * TMS9918_ROW_LINES * TMS9918_PIXELS_X);
+  }
+
+  vrEmuTms9918PortState portState;
+  vrEmuTms9918GetPortState(tms9918, &portState);
+
+  return vrEmuTms9918FrameBufferPublish(frameBuffer, portState.status);
+}
+
+/* Function:  vrEmuTms9918FrameBufferAcquire
+ * ----------------------------------------
+ * the latest published frame
+ */
+VR_EMU_TMS9918_DLLEXPORT
+const vrEmuTms9918Frame* vrEmuTms9918FrameBufferAcquire(VrEmuTms9918FrameBuffer* frameBuffer)
+{
+  if (frameBuffer == NULL)
+    return NULL;
+
+  if (FB_LOAD(&frameBuffer->ready) & FRAME_BUFFER_FRESH)
+  {
+    /* hand our frame back, take the ready one */
+    frameBuffer->front = FB_EXCHANGE(&frameBuffer->ready, frameBuffer->front) & FRAME_BUFFER_INDEX;
+    frameBuffer->hasFront = true;
+  }
+
+  return frameBuffer->hasFront ? &frameBuffer->frames[frameBuffer->front] : NULL;
+}
@@ -0,0 +1,93 @@
+/*
+ * Troy's TMS9918 Emulator - Triple-buffered frame presentation
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_FRAME_BUFFER_H_
+#define _VR_EMU_TMS9918_FRAME_BUFFER_H_
+
+#include "vrEmuTms9918.h"
+
+/* ------------------------------------------------------------------
+ * hands complete frames from one render thread to one present thread
+ * without locks or tearing.
+ *
+ * three frames rotate between the roles of back (being rendered),
+ * ready (the latest published frame) and front (being presented).
+ * publishing swaps back and ready, acquiring swaps ready and front.
+ * both are a single atomic exchange, so neither thread ever waits. the
+ * renderer never stalls on a slow consumer. frames it publishes before
+ * the consumer acquires them are dropped (only the latest is kept)
+ */
+
+/* PRIVATE DATA STRUCTURES
+ * ---------------------------------------- */
+struct vrEmuTms9918FrameBuffer_s;
+typedef struct vrEmuTms9918FrameBuffer_s VrEmuTms9918FrameBuffer;
+
+/* a frame */
+typedef struct
+{
+  uint8_t pixels[TMS9918_PIXELS_X * TMS9918_PIXELS_Y];  /* palette indexes */
+  uint64_t frameNumber;   /* 1 for the first published frame */
+  uint8_t status;         /* status register at the end of the frame */
+} vrEmuTms9918Frame;
+
+
+/* PUBLIC INTERFACE
+ * ---------------------------------------- */
+
+/* Function:  vrEmuTms9918FrameBufferNew
+ * --------------------
+ * create a triple buffer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918FrameBuffer* vrEmuTms9918FrameBufferNew(void);
+
+/* Function:  vrEmuTms9918FrameBufferDestroy
+ * --------------------
+ * destroy a triple buffer (once both threads are done with it)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918FrameBufferDestroy(VrEmuTms9918FrameBuffer* frameBuffer);
+
+/* Function:  vrEmuTms9918FrameBufferBack
+ * --------------------
+ * renderer: the frame to render into next (eg. with vrEmuTms9918RunFrame)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+vrEmuTms9918Frame* vrEmuTms9918FrameBufferBack(VrEmuTms9918FrameBuffer* frameBuffer);
+
+/* Function:  vrEmuTms9918FrameBufferPublish
+ * --------------------
+ * renderer: publish the back frame with the given status and get a new
+ * back frame. returns the published frame number
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint64_t vrEmuTms9918FrameBufferPublish(VrEmuTms9918FrameBuffer* frameBuffer, uint8_t status);
+
+/* Function:  vrEmuTms9918FrameBufferRender
+ * --------------------
+ * renderer: render a frame of tms9918 with vrEmuTms9918ScanRow() into the
+ * back frame and publish it with the resulting status (not cleared, as
+ * the cpu hasn't read it). returns the published frame number
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint64_t vrEmuTms9918FrameBufferRender(VrEmuTms9918FrameBuffer* frameBuffer, VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918FrameBufferAcquire
+ * --------------------
+ * consumer: the latest published frame. it stays valid and unchanged
+ * until the next acquire. returns the same frame again if nothing new has
+ * been published, or NULL if nothing has been published yet
+ */
+VR_EMU_TMS9918_DLLEXPORT
+const vrEmuTms9918Frame* vrEmuTms9918FrameBufferAcquire(VrEmuTms9918FrameBuffer* frameBuffer);
+
+#endif // _VR_EMU_TMS9918_FRAME_BUFFER_H_
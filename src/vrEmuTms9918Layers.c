@@ -0,0 +1,244 @@
+/*
+ * Troy's TMS9918 Emulator - Layered background/sprite rendering
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#include "vrEmuTms9918Layers.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#undef VR_EMU_TMS9918_DLLEXPORT
+#define VR_EMU_TMS9918_DLLEXPORT
+#endif
+
+#define GRAPHICS_NAME_BYTES      768
+#define TEXT_NAME_BYTES          960
+#define PATTERN_TABLE_BYTES     2048
+#define GFXI_COLOR_TABLE_BYTES    32
+#define GFXII_TABLE_BYTES       6144  /* three 2KB pages */
+
+#define TMS_R0_BACKGROUND_MASK  0x02  /* graphics ii */
+#define TMS_R1_BACKGROUND_MASK  0x58  /* display active, text, multicolor */
+
+/* registers + name table + pattern table + color table (graphics ii) */
+#define LAYERS_KEY_BYTES  (TMS_NUM_REGISTERS + TEXT_NAME_BYTES + GFXII_TABLE_BYTES * 2)
+
+ /* PRIVATE DATA STRUCTURES
+  * ---------------------- */
+struct vrEmuTms9918Layers_s
+{
+  uint8_t background[TMS_LAYER_PIXELS];
+  uint8_t sprites[TMS_LAYER_PIXELS];
+
+  /* everything the cached background was rendered from */
+  bool valid;
+  VrEmuTms9918* source;
+  uint32_t epoch;
+  size_t keySize;
+  uint8_t key[LAYERS_KEY_BYTES];
+  uint8_t newKey[LAYERS_KEY_BYTES];
+};
+
+
+/* Function:  layersAppendVram
+ * ----------------------------------------
+ * append numBytes of vram from addr to the key (wrapping as the renderer does)
+ */
+static size_t layersAppendVram(VrEmuTms9918* tms9918, uint8_t* key, size_t keySize, uint16_t addr, size_t numBytes)
+{
+  vrEmuTms9918ReadVram(tms9918, addr, key + keySize, numBytes);
+  return keySize + numBytes;
+}
+
+/* Function:  layersBackgroundKey
+ * ----------------------------------------
+ * gather the registers and vram tables the background is rendered from.
+ * returns the key size
+ */
+static size_t layersBackgroundKey(VrEmuTms9918* tms9918, uint8_t* key)
+{
+  const uint16_t mask = (uint16_t)(vrEmuTms9918GetVramSize(tms9918) - 1);
+  const vrEmuTms9918Mode mode = vrEmuTms9918DisplayMode(tms9918);
+  const bool gfxII = mode == TMS_MODE_GRAPHICS_II;
+
+  size_t keySize = 0;
+  key[keySize++] = vrEmuTms9918RegValue(tms9918, TMS_REG_0) & TMS_R0_BACKGROUND_MASK;
+  key[keySize++] = vrEmuTms9918RegValue(tms9918, TMS_REG_1) & TMS_R1_BACKGROUND_MASK;
+  key[keySize++] = vrEmuTms9918RegValue(tms9918, TMS_REG_NAME_TABLE);
+  key[keySize++] = vrEmuTms9918RegValue(tms9918, TMS_REG_COLOR_TABLE);
+  key[keySize++] = vrEmuTms9918RegValue(tms9918, TMS_REG_PATTERN_TABLE);
+  key[keySize++] = vrEmuTms9918RegValue(tms9918, TMS_REG_FG_BG_COLOR);
+  key[keySize++] = (uint8_t)(mask >> 8);
+
+  if (!vrEmuTms9918DisplayEnabled(tms9918))
+    return keySize;
+
+  const uint16_t name = ((vrEmuTms9918RegValue(tms9918, TMS_REG_NAME_TABLE) & 0x0f) << 10) & mask;
+  const uint16_t color = ((vrEmuTms9918RegValue(tms9918, TMS_REG_COLOR_TABLE) & (gfxII ? 0x80 : 0xff)) << 6) & mask;
+  const uint16_t pattern = ((vrEmuTms9918RegValue(tms9918, TMS_REG_PATTERN_TABLE) & (gfxII ? 0x04 : 0x07)) << 11) & mask;
+
+  switch (mode)
+  {
+    case TMS_MODE_GRAPHICS_I:
+      keySize = layersAppendVram(tms9918, key, keySize, name, GRAPHICS_NAME_BYTES);
+      keySize = layersAppendVram(tms9918, key, keySize, pattern, PATTERN_TABLE_BYTES);
+      keySize = layersAppendVram(tms9918, key, keySize, color, GFXI_COLOR_TABLE_BYTES);
+      break;
+
+    case TMS_MODE_GRAPHICS_II:
+      /* all three pages, whichever the page masks select */
+      keySize = layersAppendVram(tms9918, key, keySize, name, GRAPHICS_NAME_BYTES);
+      keySize = layersAppendVram(tms9918, key, keySize, pattern, GFXII_TABLE_BYTES);
+      keySize = layersAppendVram(tms9918, key, keySize, color, GFXII_TABLE_BYTES);
+      break;
+
+    case TMS_MODE_TEXT:
+      keySize = layersAppendVram(tms9918, key, keySize, name, TEXT_NAME_BYTES);
+      keySize = layersAppendVram(tms9918, key, keySize, pattern, PATTERN_TABLE_BYTES);
+      break;
+
+    case TMS_MODE_MULTICOLOR:
+      keySize = layersAppendVram(tms9918, key, keySize, name, GRAPHICS_NAME_BYTES);
+      keySize = layersAppendVram(tms9918, key, keySize, pattern, PATTERN_TABLE_BYTES);
+      break;
+  }
+
+  return keySize;
+}
+
+/* Function:  vrEmuTms9918LayersNew
+ * ----------------------------------------
+ * create a layered renderer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918Layers* vrEmuTms9918LayersNew(void)
+{
+  VrEmuTms9918Layers* layers = (VrEmuTms9918Layers*)malloc(sizeof(VrEmuTms9918Layers));
+  if (layers == NULL)
+    return NULL;
+
+  memset(layers->background, 0, sizeof(layers->background));
+  memset(layers->sprites, TMS_TRANSPARENT, sizeof(layers->sprites));
+  layers->valid = false;
+  layers->source = NULL;
+  layers->epoch = 0;
+  layers->keySize = 0;
+
+  return layers;
+}
+
+/* Function:  vrEmuTms9918LayersDestroy
+ * ----------------------------------------
+ * destroy a layered renderer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918LayersDestroy(VrEmuTms9918Layers* layers)
+{
+  free(layers);
+}
+
+/* Function:  vrEmuTms9918LayersRender
+ * ----------------------------------------
+ * render a frame into the layers
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918LayersRender(VrEmuTms9918Layers* layers, VrEmuTms9918* tms9918, uint8_t* frame)
+{
+  if (layers == NULL || tms9918 == NULL)
+    return false;
+
+  /* background. only when its inputs have changed. nothing written since
+   * the last render means nothing changed, so the key is only gathered
+   * and compared after a write */
+  const uint32_t epoch = vrEmuTms9918WriteEpoch(tms9918);
+  bool rendered = false;
+  if (!layers->valid || layers->source != tms9918 || layers->epoch != epoch)
+  {
+    const size_t keySize = layersBackgroundKey(tms9918, layers->newKey);
+    rendered = !layers->valid || keySize != layers->keySize ||
+               memcmp(layers->newKey, layers->key, keySize) != 0;
+    if (rendered)
+    {
+      for (uint8_t y = 0; y < TMS9918_PIXELS_Y; ++y)
+      {
+        vrEmuTms9918BackgroundScanLine(tms9918, y, layers->background + y * TMS9918_PIXELS_X);
+      }
+      memcpy(layers->key, layers->newKey, keySize);
+      layers->keySize = keySize;
+      layers->valid = true;
+    }
+    layers->source = tms9918;
+    layers->epoch = epoch;
+  }
+
+  /* sprites. always, for the status register */
+  memset(layers->sprites, TMS_TRANSPARENT, sizeof(layers->sprites));
+  for (uint8_t y = 0; y < TMS9918_PIXELS_Y; ++y)
+  {
+    vrEmuTms9918SpriteScanLine(tms9918, y, layers->sprites + y * TMS9918_PIXELS_X);
+  }
+
+  if (frame)
+  {
+    /* sprites are sparse. copy background a word at a time where there are none */
+    for (size_t i = 0; i < TMS_LAYER_PIXELS; i += sizeof(uint64_t))
+    {
+      uint64_t sprites;
+      memcpy(&sprites, layers->sprites + i, sizeof(sprites));
+      if (sprites == 0)
+      {
+        memcpy(frame + i, layers->background + i, sizeof(sprites));
+        continue;
+      }
+
+      for (size_t j = i; j < i + sizeof(uint64_t); ++j)
+      {
+        const uint8_t sprite = layers->sprites[j];
+        frame[j] = sprite != TMS_TRANSPARENT ? sprite : layers->background[j];
+      }
+    }
+  }
+
+  return rendered;
+}
+
+/* Function:  vrEmuTms9918LayersInvalidate
+ * ----------------------------------------
+ * force the next render to re-render the background
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918LayersInvalidate(VrEmuTms9918Layers* layers)
+{
+  if (layers)
+  {
+    layers->valid = false;
+  }
+}
+
+/* Function:  vrEmuTms9918LayersBackground
+ * ----------------------------------------
+ * background layer of the last render
+ */
+VR_EMU_TMS9918_DLLEXPORT
+const uint8_t* vrEmuTms9918LayersBackground(const VrEmuTms9918Layers* layers)
+{
+  return layers ? layers->background : NULL;
+}
+
+/* Function:  vrEmuTms9918LayersSprites
+ * ----------------------------------------
+ * sprite layer of the last render
+ */
+VR_EMU_TMS9918_DLLEXPORT
+const uint8_t* vrEmuTms9918LayersSprites(const VrEmuTms9918Layers* layers)
+{
+  return layers ? layers->sprites : NULL;
+}
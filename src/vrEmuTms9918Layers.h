@@ -0,0 +1,89 @@
+/*
+ * Troy's TMS9918 Emulator - Layered background/sprite rendering
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_LAYERS_H_
+#define _VR_EMU_TMS9918_LAYERS_H_
+
+#include "vrEmuTms9918.h"
+
+/* ------------------------------------------------------------------
+ * renders frames as two layers: the background (tiles and backdrop) and
+ * the sprites. the background is cached and only re-rendered when the
+ * registers or vram it depends on change. when only the sprite tables
+ * change (sprites moving over a static screen) a frame costs just the
+ * sprite evaluation and compositing.
+ *
+ * the sprite layer holds palette indexes, with TMS_TRANSPARENT where no
+ * sprite pixel is shown. compositing the sprite layer over the background
+ * gives the same frame as vrEmuTms9918ScanLine()
+ */
+
+#define TMS_LAYER_PIXELS  (TMS9918_PIXELS_X * TMS9918_PIXELS_Y)
+
+/* PRIVATE DATA STRUCTURES
+ * ---------------------------------------- */
+struct vrEmuTms9918Layers_s;
+typedef struct vrEmuTms9918Layers_s VrEmuTms9918Layers;
+
+
+/* PUBLIC INTERFACE
+ * ---------------------------------------- */
+
+/* Function:  vrEmuTms9918LayersNew
+ * --------------------
+ * create a layered renderer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918Layers* vrEmuTms9918LayersNew(void);
+
+/* Function:  vrEmuTms9918LayersDestroy
+ * --------------------
+ * destroy a layered renderer
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918LayersDestroy(VrEmuTms9918Layers* layers);
+
+/* Function:  vrEmuTms9918LayersRender
+ * --------------------
+ * render a frame of tms9918 into the layers, updating the status register
+ * and INT as for vrEmuTms9918ScanLine() on each line
+ *
+ * frame: TMS_LAYER_PIXELS composited palette indexes (or NULL)
+ *
+ * returns true if the background was re-rendered
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918LayersRender(VrEmuTms9918Layers* layers, VrEmuTms9918* tms9918, uint8_t* frame);
+
+/* Function:  vrEmuTms9918LayersInvalidate
+ * --------------------
+ * force the next render to re-render the background. needed when the
+ * instance rendered last is destroyed and another created in its place
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918LayersInvalidate(VrEmuTms9918Layers* layers);
+
+/* Function:  vrEmuTms9918LayersBackground
+ * --------------------
+ * background layer of the last render (TMS_LAYER_PIXELS palette indexes)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+const uint8_t* vrEmuTms9918LayersBackground(const VrEmuTms9918Layers* layers);
+
+/* Function:  vrEmuTms9918LayersSprites
+ * --------------------
+ * sprite layer of the last render (TMS_LAYER_PIXELS palette indexes,
+ * TMS_TRANSPARENT where uncovered)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+const uint8_t* vrEmuTms9918LayersSprites(const VrEmuTms9918Layers* layers);
+
+#endif // _VR_EMU_TMS9918_LAYERS_H_
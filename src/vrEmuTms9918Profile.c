@@ -0,0 +1,139 @@
+/*
+ * Troy's TMS9918 Emulator - VRAM access profile export
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#include "vrEmuTms9918Profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef WIN32
+#undef VR_EMU_TMS9918_DLLEXPORT
+#define VR_EMU_TMS9918_DLLEXPORT
+#endif
+
+#define HEATMAP_BLOCKS_PER_ROW    16
+#define HEATMAP_CELL_PX           (TMS_PROFILE_HEATMAP_SIZE / HEATMAP_BLOCKS_PER_ROW)
+
+/* Function:  bitLength
+ * ----------------------------------------
+ * number of significant bits (integer log2 + 1)
+ */
+static int bitLength(uint32_t value)
+{
+  int bits = 0;
+  while (value)
+  {
+    ++bits;
+    value >>= 1;
+  }
+  return bits;
+}
+
+/* Function:  vrEmuTms9918ProfileClear
+ * ----------------------------------------
+ * zero all counters
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ProfileClear(vrEmuTms9918Profile* profile)
+{
+  if (profile)
+  {
+    memset(profile, 0, sizeof(*profile));
+  }
+}
+
+/* Function:  vrEmuTms9918ProfileTotalFetches
+ * ----------------------------------------
+ * sum the renderer fetches of all tables per block
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ProfileTotalFetches(const vrEmuTms9918Profile* profile, uint32_t counts[TMS_PROFILE_BLOCKS])
+{
+  if (profile == NULL || counts == NULL)
+    return;
+
+  for (int block = 0; block < TMS_PROFILE_BLOCKS; ++block)
+  {
+    counts[block] = 0;
+    for (int table = 0; table < TMS_PROFILE_NUM_TABLES; ++table)
+    {
+      counts[block] += profile->fetches[table][block];
+    }
+  }
+}
+
+/* Function:  vrEmuTms9918ProfileWriteCsv
+ * ----------------------------------------
+ * write all counters as csv
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ProfileWriteCsv(const vrEmuTms9918Profile* profile, const char* filename)
+{
+  if (profile == NULL || filename == NULL)
+    return false;
+
+  FILE* file = fopen(filename, "w");
+  if (file == NULL)
+    return false;
+
+  fprintf(file, "block,address,port_writes,port_reads,name,color,pattern,sprite_attr,sprite_pattern,frames\n");
+  for (int block = 0; block < TMS_PROFILE_BLOCKS; ++block)
+  {
+    fprintf(file, "%d,0x%04x,%lu,%lu", block, block * TMS_PROFILE_BLOCK_BYTES,
+            (unsigned long)profile->portWrites[block], (unsigned long)profile->portReads[block]);
+
+    for (int table = 0; table < TMS_PROFILE_NUM_TABLES; ++table)
+    {
+      fprintf(file, ",%lu", (unsigned long)profile->fetches[table][block]);
+    }
+    fprintf(file, ",%lu\n", (unsigned long)profile->frames);
+  }
+
+  return fclose(file) == 0;
+}
+
+/* Function:  vrEmuTms9918ProfileWriteHeatmap
+ * ----------------------------------------
+ * write a set of block counters as a pgm
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ProfileWriteHeatmap(const uint32_t counts[TMS_PROFILE_BLOCKS], const char* filename)
+{
+  if (counts == NULL || filename == NULL)
+    return false;
+
+  uint32_t maxCount = 0;
+  for (int block = 0; block < TMS_PROFILE_BLOCKS; ++block)
+  {
+    if (counts[block] > maxCount) maxCount = counts[block];
+  }
+  const int maxBits = bitLength(maxCount);
+
+  FILE* file = fopen(filename, "wb");
+  if (file == NULL)
+    return false;
+
+  fprintf(file, "P5\n%d %d\n255\n", TMS_PROFILE_HEATMAP_SIZE, TMS_PROFILE_HEATMAP_SIZE);
+
+  uint8_t row[TMS_PROFILE_HEATMAP_SIZE];
+  for (int y = 0; y < TMS_PROFILE_HEATMAP_SIZE; ++y)
+  {
+    const int firstBlock = (y / HEATMAP_CELL_PX) * HEATMAP_BLOCKS_PER_ROW;
+    for (int x = 0; x < TMS_PROFILE_HEATMAP_SIZE; ++x)
+    {
+      const uint32_t count = counts[firstBlock + x / HEATMAP_CELL_PX];
+      row[x] = maxBits ? (uint8_t)(bitLength(count) * 255 / maxBits) : 0;
+    }
+    fwrite(row, 1, sizeof(row), file);
+  }
+
+  return fclose(file) == 0;
+}
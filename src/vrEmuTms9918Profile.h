@@ -0,0 +1,57 @@
+/*
+ * Troy's TMS9918 Emulator - VRAM access profile export
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_PROFILE_H_
+#define _VR_EMU_TMS9918_PROFILE_H_
+
+#include "vrEmuTms9918.h"
+
+/* ------------------------------------------------------------------
+ * counters are collected by the core (see vrEmuTms9918SetProfile. the
+ * core must be built with -DVR_EMU_TMS9918_PROFILE=ON). clear them at
+ * the start of each window of frames you want to profile
+ *
+ * heatmaps are 256x256 greyscale images. each 16x16 cell is a 64 byte
+ * block, 16 blocks (1KB) per row, so vram 0x0000 is top-left and 0x3fc0
+ * is bottom-right. brightness is log2 scaled to the busiest block
+ */
+
+#define TMS_PROFILE_HEATMAP_SIZE  256
+
+/* Function:  vrEmuTms9918ProfileClear
+ * --------------------
+ * zero all counters (start a new window)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ProfileClear(vrEmuTms9918Profile* profile);
+
+/* Function:  vrEmuTms9918ProfileTotalFetches
+ * --------------------
+ * sum the renderer fetches of all tables per block
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ProfileTotalFetches(const vrEmuTms9918Profile* profile, uint32_t counts[TMS_PROFILE_BLOCKS]);
+
+/* Function:  vrEmuTms9918ProfileWriteCsv
+ * --------------------
+ * write all counters as csv. one row per block
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ProfileWriteCsv(const vrEmuTms9918Profile* profile, const char* filename);
+
+/* Function:  vrEmuTms9918ProfileWriteHeatmap
+ * --------------------
+ * write a set of block counters (eg. profile->portWrites) as a pgm
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ProfileWriteHeatmap(const uint32_t counts[TMS_PROFILE_BLOCKS], const char* filename);
+
+#endif // _VR_EMU_TMS9918_PROFILE_H_
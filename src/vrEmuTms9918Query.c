@@ -0,0 +1,436 @@
+/*
+ * Troy's TMS9918 Emulator - Screen state queries
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#include "vrEmuTms9918Query.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#undef VR_EMU_TMS9918_DLLEXPORT
+#define VR_EMU_TMS9918_DLLEXPORT
+#endif
+
+#define PATTERN_BYTES              8
+#define GFXI_COLOR_GROUP_SIZE      8
+#define GRAPHICS_NUM_COLS         32
+#define GRAPHICS_CHAR_WIDTH        8
+#define TEXT_NUM_COLS             40
+#define TEXT_CHAR_WIDTH            6
+#define TEXT_PADDING_PX            8
+#define TILES_PER_PAGE           256
+
+#define MAX_SCANLINE_SPRITES       4
+
+#define FONT_HASH_BITS            10  /* 1024 slots. at most 75% full */
+#define FONT_HASH_SIZE          (1 << FONT_HASH_BITS)
+
+ /* PRIVATE DATA STRUCTURES
+  * ---------------------- */
+typedef struct
+{
+  uint64_t pattern;
+  char ch;
+  bool used;
+} vrEmuTms9918FontGlyph;
+
+struct vrEmuTms9918Font_s
+{
+  uint16_t count;
+  vrEmuTms9918FontGlyph glyphs[FONT_HASH_SIZE];
+};
+
+
+/* Function:  queryResolveColor
+ * ----------------------------------------
+ * transparent becomes the backdrop color
+ */
+static vrEmuTms9918Color queryResolveColor(VrEmuTms9918* tms9918, uint8_t color)
+{
+  return (color & 0x0f) == TMS_TRANSPARENT
+    ? (vrEmuTms9918Color)(vrEmuTms9918RegValue(tms9918, TMS_REG_FG_BG_COLOR) & 0x0f)
+    : (vrEmuTms9918Color)(color & 0x0f);
+}
+
+/* Function:  queryTile
+ * ----------------------------------------
+ * the tile at pixel (x, y) whether displayed or not
+ */
+static bool queryTile(VrEmuTms9918* tms9918, uint8_t x, uint8_t y, vrEmuTms9918TileHit* hit)
+{
+  const vrEmuTms9918Mode mode = vrEmuTms9918DisplayMode(tms9918);
+  const bool gfxII = mode == TMS_MODE_GRAPHICS_II;
+  const uint16_t mask = (uint16_t)(vrEmuTms9918GetVramSize(tms9918) - 1);
+  const uint8_t r3 = vrEmuTms9918RegValue(tms9918, TMS_REG_COLOR_TABLE);
+  const uint8_t r4 = vrEmuTms9918RegValue(tms9918, TMS_REG_PATTERN_TABLE);
+
+  const uint16_t nameTable = ((vrEmuTms9918RegValue(tms9918, TMS_REG_NAME_TABLE) & 0x0f) << 10) & mask;
+  const uint16_t colorTable = ((r3 & (gfxII ? 0x80 : 0xff)) << 6) & mask;
+  const uint16_t patternTable = ((r4 & (gfxII ? 0x04 : 0x07)) << 11) & mask;
+
+  const uint8_t pattRow = y & 0x07;
+  uint8_t bit = x & 0x07;
+
+  hit->row = y >> 3;
+
+  if (mode == TMS_MODE_TEXT)
+  {
+    if (x < TEXT_PADDING_PX || x >= TMS9918_PIXELS_X - TEXT_PADDING_PX)
+      return false;
+
+    hit->col = (uint8_t)((x - TEXT_PADDING_PX) / TEXT_CHAR_WIDTH);
+    bit = (uint8_t)((x - TEXT_PADDING_PX) % TEXT_CHAR_WIDTH);
+    hit->nameAddr = (uint16_t)(nameTable + hit->row * TEXT_NUM_COLS + hit->col);
+  }
+  else
+  {
+    hit->col = x / GRAPHICS_CHAR_WIDTH;
+    hit->nameAddr = (uint16_t)(nameTable + hit->row * GRAPHICS_NUM_COLS + hit->col);
+  }
+
+  hit->name = vrEmuTms9918VramValue(tms9918, hit->nameAddr);
+  hit->tile = hit->name;
+
+  switch (mode)
+  {
+    case TMS_MODE_GRAPHICS_I:
+      hit->patternAddr = (uint16_t)(patternTable + hit->name * PATTERN_BYTES + pattRow);
+      hit->colorAddr = (uint16_t)(colorTable + hit->name / GFXI_COLOR_GROUP_SIZE);
+      hit->pattern = vrEmuTms9918VramValue(tms9918, hit->patternAddr);
+      hit->colorByte = vrEmuTms9918VramValue(tms9918, hit->colorAddr);
+      break;
+
+    case TMS_MODE_GRAPHICS_II:
+    {
+      /* see vrEmuTms9918GraphicsIIScanLine */
+      const uint8_t nameMask = (uint8_t)(((r3 & 0x7f) << 3) | 0x07);
+      const uint16_t pageOffset = (uint16_t)((((hit->row & 0x18) >> 3) & (r4 & 0x03)) << 11);
+      const uint16_t pattRowOffset = (uint16_t)((hit->name & nameMask) * PATTERN_BYTES + pattRow);
+
+      hit->tile = (uint16_t)((hit->row >> 3) * TILES_PER_PAGE + (hit->name & nameMask));
+      hit->patternAddr = (uint16_t)(((patternTable + pageOffset) & mask) + pattRowOffset);
+      hit->colorAddr = (uint16_t)(((colorTable + (pageOffset & ((r3 & 0x60) << 6))) & mask) + pattRowOffset);
+      hit->pattern = vrEmuTms9918VramValue(tms9918, hit->patternAddr);
+      hit->colorByte = vrEmuTms9918VramValue(tms9918, hit->colorAddr);
+      break;
+    }
+
+    case TMS_MODE_TEXT:
+      hit->patternAddr = (uint16_t)(patternTable + hit->name * PATTERN_BYTES + pattRow);
+      hit->colorAddr = 0;
+      hit->pattern = vrEmuTms9918VramValue(tms9918, hit->patternAddr);
+      hit->colorByte = vrEmuTms9918RegValue(tms9918, TMS_REG_FG_BG_COLOR);
+      break;
+
+    case TMS_MODE_MULTICOLOR:
+      /* the "pattern" is a color byte. left half fg, right half bg */
+      hit->tile = (uint16_t)((hit->row & 0x03) * TILES_PER_PAGE + hit->name);
+      hit->patternAddr = (uint16_t)(patternTable + hit->name * PATTERN_BYTES + ((y / 4) & 0x01) + (hit->row & 0x03) * 2);
+      hit->colorAddr = hit->patternAddr;
+      hit->colorByte = vrEmuTms9918VramValue(tms9918, hit->patternAddr);
+      hit->pattern = 0xf0;
+      break;
+  }
+
+  hit->foreground = (hit->pattern << bit) & 0x80;
+  hit->color = queryResolveColor(tms9918, hit->foreground ? (hit->colorByte >> 4) : hit->colorByte);
+  return true;
+}
+
+/* Function:  vrEmuTms9918QueryTile
+ * ----------------------------------------
+ * the background tile at pixel (x, y)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918QueryTile(VrEmuTms9918* tms9918, uint8_t x, uint8_t y, vrEmuTms9918TileHit* hit)
+{
+  if (tms9918 == NULL || hit == NULL || y >= TMS9918_PIXELS_Y || !vrEmuTms9918DisplayEnabled(tms9918))
+    return false;
+
+  return queryTile(tms9918, x, y, hit);
+}
+
+/* Function:  vrEmuTms9918QuerySpriteAt
+ * ----------------------------------------
+ * the sprite whose color is displayed at pixel (x, y)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918QuerySpriteAt(VrEmuTms9918* tms9918, uint8_t x, uint8_t y, vrEmuTms9918AtlasSprite* sprite)
+{
+  if (tms9918 == NULL || y >= TMS9918_PIXELS_Y)
+    return false;
+
+  vrEmuTms9918AtlasSprite sprites[TMS_ATLAS_MAX_SPRITES];
+  const uint8_t count = vrEmuTms9918AtlasSprites(tms9918, sprites);
+
+  const uint16_t mask = (uint16_t)(vrEmuTms9918GetVramSize(tms9918) - 1);
+  const uint16_t patternTable = ((vrEmuTms9918RegValue(tms9918, TMS_REG_SPRITE_PATT_TABLE) & 0x07) << 11) & mask;
+
+  uint8_t spritesShown = 0;
+  uint8_t spriteBits = 0;   /* as vrEmuTms9918OutputSprites' rowSpriteBits[x] */
+  bool found = false;
+
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    const vrEmuTms9918AtlasSprite* info = &sprites[i];
+
+    const int pattRow = (y - info->y) >> info->magnified;
+    if (y < info->y || pattRow >= (info->sizePx >> info->magnified))
+      continue;
+
+    if (++spritesShown > MAX_SCANLINE_SPRITES)
+      break;
+
+    const int col = (x - info->x) >> info->magnified;
+    if (x < info->x || col >= (info->sizePx >> info->magnified))
+      continue;
+
+    /* 16x16 sprites: columns 8 - 15 come from the pattern 16 bytes on */
+    const uint16_t pattAddr = (uint16_t)(patternTable + info->pattern * PATTERN_BYTES + pattRow + (col >= 8 ? PATTERN_BYTES * 2 : 0));
+    if (((vrEmuTms9918VramValue(tms9918, pattAddr) << (col & 0x07)) & 0x80) == 0)
+      continue;
+
+    if (info->color != TMS_TRANSPARENT && spriteBits < 2)
+    {
+      if (sprite)
+      {
+        *sprite = *info;
+      }
+      found = true;
+    }
+
+    if (spriteBits == 0)
+    {
+      spriteBits = (uint8_t)(info->color + 1);
+    }
+  }
+
+  return found;
+}
+
+/* Function:  vrEmuTms9918QueryPixel
+ * ----------------------------------------
+ * the displayed color at pixel (x, y)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+vrEmuTms9918Color vrEmuTms9918QueryPixel(VrEmuTms9918* tms9918, uint8_t x, uint8_t y)
+{
+  if (tms9918 == NULL)
+    return TMS_TRANSPARENT;
+
+  vrEmuTms9918AtlasSprite sprite;
+  if (vrEmuTms9918QuerySpriteAt(tms9918, x, y, &sprite))
+    return sprite.color;
+
+  vrEmuTms9918TileHit hit;
+  if (vrEmuTms9918QueryTile(tms9918, x, y, &hit))
+    return hit.color;
+
+  return queryResolveColor(tms9918, vrEmuTms9918RegValue(tms9918, TMS_REG_FG_BG_COLOR));
+}
+
+/* Function:  fontKey
+ * ----------------------------------------
+ * pack a glyph pattern
+ */
+static uint64_t fontKey(const uint8_t pattern[PATTERN_BYTES])
+{
+  uint64_t key = 0;
+  for (int i = 0; i < PATTERN_BYTES; ++i)
+  {
+    key = (key << 8) | pattern[i];
+  }
+  return key;
+}
+
+/* Function:  fontFind
+ * ----------------------------------------
+ * the slot holding key, or the empty slot it belongs in
+ */
+static const vrEmuTms9918FontGlyph* fontFind(const VrEmuTms9918Font* font, uint64_t key)
+{
+  unsigned int slot = (unsigned int)((key * 0x9e3779b97f4a7c15ull) >> (64 - FONT_HASH_BITS));
+  while (font->glyphs[slot].used && font->glyphs[slot].pattern != key)
+  {
+    slot = (slot + 1) & (FONT_HASH_SIZE - 1);
+  }
+  return &font->glyphs[slot];
+}
+
+/* Function:  vrEmuTms9918FontNew
+ * ----------------------------------------
+ * create an empty font
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918Font* vrEmuTms9918FontNew(void)
+{
+  VrEmuTms9918Font* font = (VrEmuTms9918Font*)malloc(sizeof(VrEmuTms9918Font));
+  if (font)
+  {
+    memset(font, 0, sizeof(VrEmuTms9918Font));
+  }
+  return font;
+}
+
+/* Function:  vrEmuTms9918FontDestroy
+ * ----------------------------------------
+ * destroy a font
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918FontDestroy(VrEmuTms9918Font* font)
+{
+  free(font);
+}
+
+/* Function:  vrEmuTms9918FontAdd
+ * ----------------------------------------
+ * map a glyph pattern to ch
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918FontAdd(VrEmuTms9918Font* font, const uint8_t pattern[8], char ch)
+{
+  if (font == NULL || pattern == NULL)
+    return false;
+
+  const uint64_t key = fontKey(pattern);
+  vrEmuTms9918FontGlyph* glyph = (vrEmuTms9918FontGlyph*)fontFind(font, key);
+  if (!glyph->used)
+  {
+    if (font->count == TMS_FONT_MAX_GLYPHS)
+      return false;
+
+    glyph->used = true;
+    glyph->pattern = key;
+    ++font->count;
+  }
+  glyph->ch = ch;
+  return true;
+}
+
+/* Function:  vrEmuTms9918FontAddGlyphs
+ * ----------------------------------------
+ * map consecutive glyph patterns to consecutive characters
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint16_t vrEmuTms9918FontAddGlyphs(VrEmuTms9918Font* font, const uint8_t* patterns, uint16_t count, char firstCh)
+{
+  if (patterns == NULL)
+    return 0;
+
+  uint16_t added = 0;
+  while (added < count && vrEmuTms9918FontAdd(font, patterns + added * PATTERN_BYTES, (char)(firstCh + added)))
+  {
+    ++added;
+  }
+  return added;
+}
+
+/* Function:  vrEmuTms9918FontLookup
+ * ----------------------------------------
+ * the character of a glyph pattern
+ */
+VR_EMU_TMS9918_DLLEXPORT
+char vrEmuTms9918FontLookup(const VrEmuTms9918Font* font, const uint8_t pattern[8])
+{
+  if (font == NULL || pattern == NULL)
+    return '\0';
+
+  const vrEmuTms9918FontGlyph* glyph = fontFind(font, fontKey(pattern));
+  return glyph->used ? glyph->ch : '\0';
+}
+
+/* Function:  vrEmuTms9918QueryTextGrid
+ * ----------------------------------------
+ * decode the name table as a grid of character cells
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918QueryTextGrid(VrEmuTms9918* tms9918, const VrEmuTms9918Font* font,
+                                  vrEmuTms9918TextCell cells[TMS_QUERY_TEXT_ROWS * TMS_QUERY_TEXT_MAX_COLS])
+{
+  if (tms9918 == NULL || cells == NULL)
+    return 0;
+
+  const vrEmuTms9918Mode mode = vrEmuTms9918DisplayMode(tms9918);
+  if (mode == TMS_MODE_MULTICOLOR)
+    return 0;
+
+  const bool text = mode == TMS_MODE_TEXT;
+  const uint8_t cols = text ? TEXT_NUM_COLS : GRAPHICS_NUM_COLS;
+
+  for (uint8_t row = 0; row < TMS_QUERY_TEXT_ROWS; ++row)
+  {
+    for (uint8_t col = 0; col < cols; ++col)
+    {
+      const uint8_t x = text ? (uint8_t)(TEXT_PADDING_PX + col * TEXT_CHAR_WIDTH) : (uint8_t)(col * GRAPHICS_CHAR_WIDTH);
+
+      vrEmuTms9918TileHit hit;
+      queryTile(tms9918, x, (uint8_t)(row * PATTERN_BYTES), &hit);
+
+      uint8_t pattern[PATTERN_BYTES];
+      vrEmuTms9918ReadVram(tms9918, hit.patternAddr, pattern, PATTERN_BYTES);
+
+      /* graphics ii has a color byte per pattern row */
+      uint8_t colorByte = hit.colorByte;
+      if (mode == TMS_MODE_GRAPHICS_II)
+      {
+        for (uint8_t pattRow = 0; pattRow < PATTERN_BYTES; ++pattRow)
+        {
+          if (pattern[pattRow])
+          {
+            colorByte = vrEmuTms9918VramValue(tms9918, (uint16_t)(hit.colorAddr + pattRow));
+            break;
+          }
+        }
+      }
+
+      vrEmuTms9918TextCell* cell = &cells[row * cols + col];
+      cell->name = hit.name;
+      cell->ch = vrEmuTms9918FontLookup(font, pattern);
+      cell->fg = queryResolveColor(tms9918, colorByte >> 4);
+      cell->bg = queryResolveColor(tms9918, colorByte);
+    }
+  }
+
+  return cols;
+}
+
+/* Function:  vrEmuTms9918QueryText
+ * ----------------------------------------
+ * the screen as text
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918QueryText(VrEmuTms9918* tms9918, const VrEmuTms9918Font* font, char* text, size_t size)
+{
+  if (text == NULL)
+    return 0;
+
+  vrEmuTms9918TextCell cells[TMS_QUERY_TEXT_ROWS * TMS_QUERY_TEXT_MAX_COLS];
+  const uint8_t cols = vrEmuTms9918QueryTextGrid(tms9918, font, cells);
+  const size_t length = (size_t)TMS_QUERY_TEXT_ROWS * (cols + 1);
+
+  if (cols == 0 || size <= length)
+    return 0;
+
+  char* out = text;
+  for (int row = 0; row < TMS_QUERY_TEXT_ROWS; ++row)
+  {
+    for (int col = 0; col < cols; ++col)
+    {
+      const vrEmuTms9918TextCell* cell = &cells[row * cols + col];
+      const char ch = font ? cell->ch : (char)cell->name;
+      *out++ = (ch >= ' ' && ch <= '~') ? ch : '.';
+    }
+    *out++ = '\n';
+  }
+  *out = '\0';
+
+  return length;
+}
@@ -0,0 +1,163 @@
+/*
+ * Troy's TMS9918 Emulator - Screen state queries
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_QUERY_H_
+#define _VR_EMU_TMS9918_QUERY_H_
+
+#include "vrEmuTms9918.h"
+#include "vrEmuTms9918Atlas.h"
+
+/* ------------------------------------------------------------------
+ * answers "what is at this pixel" directly from the registers and vram,
+ * without rendering. results match what vrEmuTms9918ScanLine() would
+ * draw, including the 4 sprites per line limit. queries don't affect
+ * the emulated state (status, collisions). the sprite list is
+ * vrEmuTms9918AtlasSprites()
+ */
+
+/* text grid (see vrEmuTms9918QueryTextGrid) */
+#define TMS_QUERY_TEXT_ROWS      24
+#define TMS_QUERY_TEXT_MAX_COLS  40
+#define TMS_QUERY_TEXT_MAX_BYTES (TMS_QUERY_TEXT_ROWS * (TMS_QUERY_TEXT_MAX_COLS + 1) + 1)
+
+/* font glyphs (see vrEmuTms9918FontAdd) */
+#define TMS_FONT_MAX_GLYPHS      768
+
+/* the background tile at a pixel (see vrEmuTms9918QueryTile) */
+typedef struct
+{
+  uint8_t col;            /* name table column (0 - 31, or 0 - 39 in text mode) */
+  uint8_t row;            /* name table row (0 - 23) */
+  uint8_t name;           /* name table entry */
+  uint16_t tile;          /* tile atlas index (see vrEmuTms9918Atlas.h) */
+  uint16_t nameAddr;      /* vram address of the name table entry */
+  uint16_t patternAddr;   /* vram address of the pattern (or multicolor color) byte */
+  uint16_t colorAddr;     /* vram address of the color byte (0 in text mode) */
+  uint8_t pattern;        /* pattern byte for the pixel row */
+  uint8_t colorByte;      /* fg / bg color byte for the pixel row */
+  bool foreground;        /* pixel is set in the pattern */
+  vrEmuTms9918Color color;  /* displayed color (transparent resolved to the backdrop) */
+} vrEmuTms9918TileHit;
+
+/* a character cell (see vrEmuTms9918QueryTextGrid) */
+typedef struct
+{
+  uint8_t name;           /* name table entry (character code) */
+  char ch;                /* character of the matching font glyph ('\0' if none) */
+  vrEmuTms9918Color fg;   /* displayed colors (transparent resolved to the backdrop) */
+  vrEmuTms9918Color bg;
+} vrEmuTms9918TextCell;
+
+/* glyph pattern to character map */
+struct vrEmuTms9918Font_s;
+typedef struct vrEmuTms9918Font_s VrEmuTms9918Font;
+
+
+/* PUBLIC INTERFACE
+ * ---------------------------------------- */
+
+/* Function:  vrEmuTms9918QueryTile
+ * --------------------
+ * the background tile at pixel (x, y)
+ *
+ * returns false if there is no tile there (display disabled, y out of
+ * range or text mode border), in which case the pixel is the backdrop
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918QueryTile(VrEmuTms9918* tms9918, uint8_t x, uint8_t y, vrEmuTms9918TileHit* hit);
+
+/* Function:  vrEmuTms9918QuerySpriteAt
+ * --------------------
+ * the sprite whose color is displayed at pixel (x, y)
+ *
+ * returns false if the pixel shows the background
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918QuerySpriteAt(VrEmuTms9918* tms9918, uint8_t x, uint8_t y, vrEmuTms9918AtlasSprite* sprite);
+
+/* Function:  vrEmuTms9918QueryPixel
+ * --------------------
+ * the displayed color at pixel (x, y), sprites included
+ */
+VR_EMU_TMS9918_DLLEXPORT
+vrEmuTms9918Color vrEmuTms9918QueryPixel(VrEmuTms9918* tms9918, uint8_t x, uint8_t y);
+
+/* Function:  vrEmuTms9918FontNew
+ * --------------------
+ * create an empty font
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918Font* vrEmuTms9918FontNew(void);
+
+/* Function:  vrEmuTms9918FontDestroy
+ * --------------------
+ * destroy a font
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918FontDestroy(VrEmuTms9918Font* font);
+
+/* Function:  vrEmuTms9918FontAdd
+ * --------------------
+ * map an 8 byte glyph pattern to ch (replacing any existing mapping)
+ *
+ * glyphs are matched against all 8 pattern bytes as stored in vram
+ * (text mode displays only the left 6 columns). returns false if the
+ * font already holds TMS_FONT_MAX_GLYPHS glyphs
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918FontAdd(VrEmuTms9918Font* font, const uint8_t pattern[8], char ch);
+
+/* Function:  vrEmuTms9918FontAddGlyphs
+ * --------------------
+ * map count consecutive 8 byte glyph patterns (eg. a font as uploaded to
+ * the pattern table) to consecutive characters from firstCh
+ *
+ * returns the number of glyphs added
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint16_t vrEmuTms9918FontAddGlyphs(VrEmuTms9918Font* font, const uint8_t* patterns, uint16_t count, char firstCh);
+
+/* Function:  vrEmuTms9918FontLookup
+ * --------------------
+ * the character of a glyph pattern ('\0' if not in the font)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+char vrEmuTms9918FontLookup(const VrEmuTms9918Font* font, const uint8_t pattern[8]);
+
+/* Function:  vrEmuTms9918QueryTextGrid
+ * --------------------
+ * decode the name table as a grid of character cells, matching each
+ * cell's glyph against font (optional)
+ *
+ * cells: TMS_QUERY_TEXT_ROWS x TMS_QUERY_TEXT_MAX_COLS entries. rows are packed
+ *
+ * graphics ii colors are those of the first pattern row with pixels set.
+ * returns the number of columns (40 in text mode, 32 in graphics i and
+ * ii, 0 in multicolor mode)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918QueryTextGrid(VrEmuTms9918* tms9918, const VrEmuTms9918Font* font,
+                                  vrEmuTms9918TextCell cells[TMS_QUERY_TEXT_ROWS * TMS_QUERY_TEXT_MAX_COLS]);
+
+/* Function:  vrEmuTms9918QueryText
+ * --------------------
+ * the screen as text. one line per row, each ending with '\n'
+ *
+ * characters are font matches if a font is given, otherwise name table
+ * entries. anything unmatched or unprintable becomes '.'
+ *
+ * returns the length (excluding the terminator), or 0 in multicolor
+ * mode or if size is too small (TMS_QUERY_TEXT_MAX_BYTES is always enough)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+size_t vrEmuTms9918QueryText(VrEmuTms9918* tms9918, const VrEmuTms9918Font* font, char* text, size_t size);
+
+#endif // _VR_EMU_TMS9918_QUERY_H_
@@ -0,0 +1,310 @@
+/*
+ * Troy's TMS9918 Emulator - Shared memory frame ring (POSIX)
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+/* ftruncate under strict -std=c11 */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "vrEmuTms9918ShmRing.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#undef VR_EMU_TMS9918_DLLEXPORT
+#define VR_EMU_TMS9918_DLLEXPORT
+
+#define SHM_RING_MAGIC        0x524d5354  /* "TMSR" */
+#define SHM_RING_VERSION      1
+#define SHM_RING_BLOCK_BYTES  64
+#define SHM_RING_MIN_FRAMES   2
+
+#define FRAME_PIXELS          (TMS9918_PIXELS_X * TMS9918_PIXELS_Y)
+
+ /* PRIVATE DATA STRUCTURES
+  * ---------------------- */
+
+/* shared memory header */
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t numFrames;
+  uint32_t slotBytes;
+  uint32_t reserved;
+  uint64_t latest;
+  uint8_t padding[SHM_RING_BLOCK_BYTES - 24];
+} vrEmuTms9918ShmHeader;
+
+/* shared memory slot header (followed by the pixels) */
+typedef struct
+{
+  uint64_t sequence;
+  uint8_t status;
+  uint8_t registers[TMS_NUM_REGISTERS];
+  uint8_t reserved[3];
+  uint32_t dirtyLines[TMS_SHM_RING_DIRTY_WORDS];
+  uint8_t padding[SHM_RING_BLOCK_BYTES - 20 - TMS_SHM_RING_DIRTY_WORDS * 4];
+} vrEmuTms9918ShmSlot;
+
+_Static_assert(sizeof(vrEmuTms9918ShmHeader) == SHM_RING_BLOCK_BYTES, "shm header layout");
+_Static_assert(sizeof(vrEmuTms9918ShmSlot) == SHM_RING_BLOCK_BYTES, "shm slot layout");
+
+#define SHM_RING_SLOT_BYTES   (sizeof(vrEmuTms9918ShmSlot) + FRAME_PIXELS)
+
+struct vrEmuTms9918ShmRing_s
+{
+  vrEmuTms9918ShmHeader* header;
+  size_t mappedBytes;
+
+  /* writer only */
+  char* name;
+  uint64_t sequence;
+};
+
+
+/* Function:  shmRingSlot
+ * ----------------------------------------
+ * slot holding the given frame sequence
+ */
+static inline vrEmuTms9918ShmSlot* shmRingSlot(VrEmuTms9918ShmRing* ring, uint64_t sequence)
+{
+  const uint64_t index = sequence % ring->header->numFrames;
+  return (vrEmuTms9918ShmSlot*)((uint8_t*)ring->header + sizeof(vrEmuTms9918ShmHeader) + index * ring->header->slotBytes);
+}
+
+/* Function:  shmRingPixels
+ * ----------------------------------------
+ * pixels of a slot
+ */
+static inline uint8_t* shmRingPixels(vrEmuTms9918ShmSlot* slot)
+{
+  return (uint8_t*)slot + sizeof(vrEmuTms9918ShmSlot);
+}
+
+
+/* Function:  vrEmuTms9918ShmRingCreate
+ * ----------------------------------------
+ * create a named shared memory ring for writing
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918ShmRing* vrEmuTms9918ShmRingCreate(const char* name, uint16_t numFrames)
+{
+  if (name == NULL || numFrames < SHM_RING_MIN_FRAMES)
+    return NULL;
+
+  const size_t nameBytes = strlen(name) + 1;
+  const size_t size = sizeof(vrEmuTms9918ShmHeader) + (size_t)numFrames * SHM_RING_SLOT_BYTES;
+
+  VrEmuTms9918ShmRing* ring = (VrEmuTms9918ShmRing*)malloc(sizeof(VrEmuTms9918ShmRing));
+  char* nameCopy = (char*)malloc(nameBytes);
+  if (ring == NULL || nameCopy == NULL)
+  {
+    free(ring);
+    free(nameCopy);
+    return NULL;
+  }
+  memcpy(nameCopy, name, nameBytes);
+
+  shm_unlink(name);
+  const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  void* mem = MAP_FAILED;
+  if (fd >= 0)
+  {
+    if (ftruncate(fd, (off_t)size) == 0)
+    {
+      mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+  }
+
+  if (mem == MAP_FAILED)
+  {
+    if (fd >= 0) shm_unlink(name);
+    free(ring);
+    free(nameCopy);
+    return NULL;
+  }
+
+  /* new shared memory is zero filled, so no frames are published */
+  ring->header = (vrEmuTms9918ShmHeader*)mem;
+  ring->mappedBytes = size;
+  ring->name = nameCopy;
+  ring->sequence = 0;
+
+  ring->header->version = SHM_RING_VERSION;
+  ring->header->numFrames = numFrames;
+  ring->header->slotBytes = (uint32_t)SHM_RING_SLOT_BYTES;
+  __atomic_store_n(&ring->header->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+  return ring;
+}
+
+/* Function:  vrEmuTms9918ShmRingOpen
+ * ----------------------------------------
+ * open an existing ring for reading
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918ShmRing* vrEmuTms9918ShmRingOpen(const char* name)
+{
+  if (name == NULL)
+    return NULL;
+
+  const int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0)
+    return NULL;
+
+  struct stat st;
+  void* mem = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(vrEmuTms9918ShmHeader))
+  {
+    mem = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+
+  if (mem == MAP_FAILED)
+    return NULL;
+
+  const vrEmuTms9918ShmHeader* header = (const vrEmuTms9918ShmHeader*)mem;
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC ||
+      header->version != SHM_RING_VERSION ||
+      header->numFrames < SHM_RING_MIN_FRAMES ||
+      header->slotBytes < SHM_RING_SLOT_BYTES ||
+      (size_t)st.st_size < sizeof(vrEmuTms9918ShmHeader) + (size_t)header->numFrames * header->slotBytes)
+  {
+    munmap(mem, (size_t)st.st_size);
+    return NULL;
+  }
+
+  VrEmuTms9918ShmRing* ring = (VrEmuTms9918ShmRing*)malloc(sizeof(VrEmuTms9918ShmRing));
+  if (ring == NULL)
+  {
+    munmap(mem, (size_t)st.st_size);
+    return NULL;
+  }
+
+  ring->header = (vrEmuTms9918ShmHeader*)mem;
+  ring->mappedBytes = (size_t)st.st_size;
+  ring->name = NULL;
+  ring->sequence = 0;
+
+  return ring;
+}
+
+/* Function:  vrEmuTms9918ShmRingDestroy
+ * ----------------------------------------
+ * unmap the ring (and remove it if we created it)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ShmRingDestroy(VrEmuTms9918ShmRing* ring)
+{
+  if (ring)
+  {
+    munmap(ring->header, ring->mappedBytes);
+    if (ring->name)
+    {
+      shm_unlink(ring->name);
+      free(ring->name);
+    }
+    free(ring);
+  }
+}
+
+/* Function:  vrEmuTms9918ShmRingRenderFrame
+ * ----------------------------------------
+ * render a frame into the next slot and publish it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint64_t vrEmuTms9918ShmRingRenderFrame(VrEmuTms9918ShmRing* ring, VrEmuTms9918* tms9918)
+{
+  if (ring == NULL || ring->name == NULL || tms9918 == NULL)
+    return 0;
+
+  const uint64_t sequence = ++ring->sequence;
+  vrEmuTms9918ShmSlot* slot = shmRingSlot(ring, sequence);
+  const uint8_t* prevPixels = (sequence > 1) ? shmRingPixels(shmRingSlot(ring, sequence - 1)) : NULL;
+  uint8_t* pixels = shmRingPixels(slot);
+
+  /* take the slot away from readers */
+  __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  memset(slot->dirtyLines, 0, sizeof(slot->dirtyLines));
+  for (uint8_t y = 0; y < TMS9918_PIXELS_Y; ++y)
+  {
+    uint8_t* line = pixels + y * TMS9918_PIXELS_X;
+    vrEmuTms9918ScanLine(tms9918, y, line);
+
+    if (prevPixels == NULL || memcmp(line, prevPixels + y * TMS9918_PIXELS_X, TMS9918_PIXELS_X) != 0)
+    {
+      slot->dirtyLines[y >> 5] |= 1u << (y & 31);
+    }
+  }
+
+  vrEmuTms9918PortState portState;
+  vrEmuTms9918GetPortState(tms9918, &portState);
+  slot->status = portState.status;
+  for (int reg = 0; reg < TMS_NUM_REGISTERS; ++reg)
+  {
+    slot->registers[reg] = vrEmuTms9918RegValue(tms9918, (vrEmuTms9918Register)reg);
+  }
+
+  /* publish */
+  __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+  __atomic_store_n(&ring->header->latest, sequence, __ATOMIC_RELEASE);
+
+  return sequence;
+}
+
+/* Function:  vrEmuTms9918ShmRingLatest
+ * ----------------------------------------
+ * get the latest frame if newer than afterSequence
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ShmRingLatest(VrEmuTms9918ShmRing* ring, uint64_t afterSequence, vrEmuTms9918ShmFrame* frame)
+{
+  if (ring == NULL || frame == NULL)
+    return false;
+
+  const uint64_t latest = __atomic_load_n(&ring->header->latest, __ATOMIC_ACQUIRE);
+  if (latest == 0 || latest <= afterSequence)
+    return false;
+
+  vrEmuTms9918ShmSlot* slot = shmRingSlot(ring, latest);
+  if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != latest)
+    return false;
+
+  frame->sequence = latest;
+  frame->status = slot->status;
+  memcpy(frame->registers, slot->registers, sizeof(frame->registers));
+  memcpy(frame->dirtyLines, slot->dirtyLines, sizeof(frame->dirtyLines));
+  frame->pixels = shmRingPixels(slot);
+
+  return vrEmuTms9918ShmRingValidate(ring, frame);
+}
+
+/* Function:  vrEmuTms9918ShmRingValidate
+ * ----------------------------------------
+ * check a frame's slot hasn't been reused
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ShmRingValidate(VrEmuTms9918ShmRing* ring, const vrEmuTms9918ShmFrame* frame)
+{
+  if (ring == NULL || frame == NULL)
+    return false;
+
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&shmRingSlot(ring, frame->sequence)->sequence, __ATOMIC_RELAXED) == frame->sequence;
+}
@@ -0,0 +1,114 @@
+/*
+ * Troy's TMS9918 Emulator - Shared memory frame ring (POSIX)
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_SHM_RING_H_
+#define _VR_EMU_TMS9918_SHM_RING_H_
+
+#include "vrEmuTms9918.h"
+
+/* ------------------------------------------------------------------
+ * SHARED MEMORY LAYOUT (native byte order, 64-byte aligned blocks)
+ *
+ * header:
+ *   u32             magic ("TMSR")
+ *   u16             version (1)
+ *   u16             number of frame slots
+ *   u32             slot size in bytes (slot header + pixels)
+ *   u32             reserved
+ *   u64             latest published frame sequence (0 = none yet)
+ *
+ * slot[n] (frame sequence s lives in slot s % n):
+ *   u64             frame sequence. 0 while being written
+ *   u8              status register at the end of the frame
+ *   u8[8]           registers at the end of the frame
+ *   u8[3]           reserved
+ *   u32[6]          dirty line bitmap. bit (y % 32) of word (y / 32) is
+ *                   set if line y differs from the previous frame
+ *   ...             (padding)
+ *   u8[256 * 192]   palette index pixels (at slot offset 64)
+ *
+ * one writer process renders straight into the next slot then
+ * publishes its sequence. readers never block the writer: they read a
+ * slot in place, then check its sequence is unchanged (see
+ * vrEmuTms9918ShmRingValidate)
+ */
+
+#define TMS_SHM_RING_DIRTY_WORDS  (TMS9918_PIXELS_Y / 32)
+
+/* PRIVATE DATA STRUCTURES
+ * ---------------------------------------- */
+struct vrEmuTms9918ShmRing_s;
+typedef struct vrEmuTms9918ShmRing_s VrEmuTms9918ShmRing;
+
+/* a frame as seen by a reader */
+typedef struct
+{
+  uint64_t sequence;
+  uint8_t status;
+  uint8_t registers[TMS_NUM_REGISTERS];
+  uint32_t dirtyLines[TMS_SHM_RING_DIRTY_WORDS];
+  const uint8_t* pixels;    /* points into shared memory */
+} vrEmuTms9918ShmFrame;
+
+
+/* PUBLIC INTERFACE
+ * ---------------------------------------- */
+
+/* Function:  vrEmuTms9918ShmRingCreate
+ * --------------------
+ * create (or replace) a named shared memory ring for writing
+ *
+ * name:      posix shared memory name (eg. "/tms9918-0")
+ * numFrames: number of frame slots (minimum 2)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918ShmRing* vrEmuTms9918ShmRingCreate(const char* name, uint16_t numFrames);
+
+/* Function:  vrEmuTms9918ShmRingOpen
+ * --------------------
+ * open an existing ring for reading. returns NULL if missing or invalid
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918ShmRing* vrEmuTms9918ShmRingOpen(const char* name);
+
+/* Function:  vrEmuTms9918ShmRingDestroy
+ * --------------------
+ * unmap the ring. the creator also removes the name
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918ShmRingDestroy(VrEmuTms9918ShmRing* ring);
+
+/* Function:  vrEmuTms9918ShmRingRenderFrame
+ * --------------------
+ * writer: render a full frame of tms9918 directly into the next slot
+ * and publish it. returns the published sequence
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint64_t vrEmuTms9918ShmRingRenderFrame(VrEmuTms9918ShmRing* ring, VrEmuTms9918* tms9918);
+
+/* Function:  vrEmuTms9918ShmRingLatest
+ * --------------------
+ * reader: get the latest frame if it is newer than afterSequence.
+ * dirtyLines are relative to the previous sequence, so treat all lines
+ * as dirty if frames were skipped
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ShmRingLatest(VrEmuTms9918ShmRing* ring, uint64_t afterSequence, vrEmuTms9918ShmFrame* frame);
+
+/* Function:  vrEmuTms9918ShmRingValidate
+ * --------------------
+ * reader: call after consuming frame->pixels. returns false if the writer
+ * reused the slot meanwhile (the pixels read may be torn)
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918ShmRingValidate(VrEmuTms9918ShmRing* ring, const vrEmuTms9918ShmFrame* frame);
+
+#endif // _VR_EMU_TMS9918_SHM_RING_H_
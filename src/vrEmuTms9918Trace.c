@@ -0,0 +1,726 @@
+/*
+ * Troy's TMS9918 Emulator - Port I/O trace recording / replay
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#include "vrEmuTms9918Trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#undef VR_EMU_TMS9918_DLLEXPORT
+#define VR_EMU_TMS9918_DLLEXPORT
+#endif
+
+#define TRACE_MAGIC           "TMS9918T"
+#define TRACE_MAGIC_BYTES     8
+#define TRACE_VERSION         1
+#define TRACE_HEADER_BYTES    (TRACE_MAGIC_BYTES + 2 + 4 + 2 + TMS_NUM_REGISTERS + 4 + 2)
+
+#define TRACE_OP_END          0x00
+#define TRACE_OP_TIME         0x01
+#define TRACE_OP_WRITE_ADDR   0x02
+#define TRACE_OP_WRITE_DATA   0x03
+#define TRACE_OP_WRITE_RUN    0x04
+#define TRACE_OP_READ_DATA    0x05
+#define TRACE_OP_READ_STATUS  0x06
+#define TRACE_OP_SCANLINE     0x07
+
+#define TRACE_MAX_PENDING     4096  /* max buffered data bytes */
+#define TRACE_MIN_RUN            4  /* shortest run worth encoding */
+#define TRACE_OUT_BUFFER     65536
+
+typedef enum
+{
+  PENDING_NONE,
+  PENDING_DATA,
+  PENDING_READ_DATA,
+  PENDING_READ_STATUS,
+  PENDING_SCANLINE,
+} vrEmuTms9918TracePending;
+
+ /* PRIVATE DATA STRUCTURES
+  * ---------------------- */
+struct vrEmuTms9918Trace_s
+{
+  VrEmuTms9918* tms9918;
+  FILE* file;
+  bool writeError;      /* a write to file failed (see vrEmuTms9918TraceDestroy) */
+
+  /* time tracking (in quanta) */
+  uint32_t timeQuantum;
+  uint64_t recordedTime;
+  uint64_t currentTime;
+  bool hasTime;
+
+  /* operation being coalesced */
+  vrEmuTms9918TracePending pending;
+  uint32_t pendingCount;
+  uint8_t pendingY;
+  uint8_t pendingData[TRACE_MAX_PENDING];
+
+  /* encoded output */
+  size_t outBytes;
+  uint8_t out[TRACE_OUT_BUFFER];
+};
+
+struct vrEmuTms9918TracePlayer_s
+{
+  size_t size;
+  uint8_t* data;
+};
+
+
+/* Function:  traceFlushOut
+ * ----------------------------------------
+ * write encoded output to the file
+ */
+static void traceFlushOut(VrEmuTms9918Trace* trace)
+{
+  if (trace->outBytes)
+  {
+    if (fwrite(trace->out, 1, trace->outBytes, trace->file) != trace->outBytes)
+    {
+      trace->writeError = true;
+    }
+    trace->outBytes = 0;
+  }
+}
+
+/* Function:  traceEmitByte
+ * ----------------------------------------
+ * append a byte to the encoded output
+ */
+static inline void traceEmitByte(VrEmuTms9918Trace* trace, uint8_t value)
+{
+  if (trace->outBytes == TRACE_OUT_BUFFER)
+  {
+    traceFlushOut(trace);
+  }
+  trace->out[trace->outBytes++] = value;
+}
+
+/* Function:  traceEmitVarint
+ * ----------------------------------------
+ * append a LEB128 encoded value to the encoded output
+ */
+static void traceEmitVarint(VrEmuTms9918Trace* trace, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    traceEmitByte(trace, (uint8_t)(value | 0x80));
+    value >>= 7;
+  }
+  traceEmitByte(trace, (uint8_t)value);
+}
+
+/* Function:  traceEmitData
+ * ----------------------------------------
+ * encode buffered data writes as literal and run records
+ */
+static void traceEmitData(VrEmuTms9918Trace* trace, const uint8_t* data, uint32_t count)
+{
+  uint32_t literalStart = 0;
+  uint32_t i = 0;
+
+  while (i < count)
+  {
+    uint32_t runEnd = i + 1;
+    while (runEnd < count && data[runEnd] == data[i])
+    {
+      ++runEnd;
+    }
+
+    if (runEnd - i >= TRACE_MIN_RUN)
+    {
+      if (i > literalStart)
+      {
+        traceEmitByte(trace, TRACE_OP_WRITE_DATA);
+        traceEmitVarint(trace, i - literalStart);
+        for (uint32_t j = literalStart; j < i; ++j)
+        {
+          traceEmitByte(trace, data[j]);
+        }
+      }
+
+      traceEmitByte(trace, TRACE_OP_WRITE_RUN);
+      traceEmitVarint(trace, runEnd - i);
+      traceEmitByte(trace, data[i]);
+      literalStart = runEnd;
+    }
+    i = runEnd;
+  }
+
+  if (count > literalStart)
+  {
+    traceEmitByte(trace, TRACE_OP_WRITE_DATA);
+    traceEmitVarint(trace, count - literalStart);
+    for (uint32_t j = literalStart; j < count; ++j)
+    {
+      traceEmitByte(trace, data[j]);
+    }
+  }
+}
+
+/* Function:  traceFlushPending
+ * ----------------------------------------
+ * encode the operation currently being coalesced
+ */
+static void traceFlushPending(VrEmuTms9918Trace* trace)
+{
+  switch (trace->pending)
+  {
+    case PENDING_NONE:
+      return;
+
+    case PENDING_DATA:
+      traceEmitData(trace, trace->pendingData, trace->pendingCount);
+      break;
+
+    case PENDING_READ_DATA:
+      traceEmitByte(trace, TRACE_OP_READ_DATA);
+      traceEmitVarint(trace, trace->pendingCount);
+      break;
+
+    case PENDING_READ_STATUS:
+      traceEmitByte(trace, TRACE_OP_READ_STATUS);
+      traceEmitVarint(trace, trace->pendingCount);
+      break;
+
+    case PENDING_SCANLINE:
+      traceEmitByte(trace, TRACE_OP_SCANLINE);
+      traceEmitByte(trace, trace->pendingY);
+      traceEmitVarint(trace, trace->pendingCount);
+      break;
+  }
+
+  trace->pending = PENDING_NONE;
+  trace->pendingCount = 0;
+}
+
+/* Function:  traceBegin
+ * ----------------------------------------
+ * prepare to record an operation. returns true if it can be
+ * coalesced with the pending operation
+ */
+static bool traceBegin(VrEmuTms9918Trace* trace, vrEmuTms9918TracePending op)
+{
+  if (trace->currentTime != trace->recordedTime)
+  {
+    traceFlushPending(trace);
+    traceEmitByte(trace, TRACE_OP_TIME);
+    traceEmitVarint(trace, trace->currentTime - trace->recordedTime);
+    trace->recordedTime = trace->currentTime;
+  }
+
+  if (trace->pending == op)
+  {
+    return true;
+  }
+
+  traceFlushPending(trace);
+  trace->pending = op;
+  return false;
+}
+
+/* Function:  traceCount
+ * ----------------------------------------
+ * record a repeatable, operand-less operation
+ */
+static void traceCount(VrEmuTms9918Trace* trace, vrEmuTms9918TracePending op)
+{
+  traceBegin(trace, op);
+  ++trace->pendingCount;
+}
+
+/* Function:  writeLE16
+ * ----------------------------------------
+ * write a 16-bit little endian value
+ */
+static inline void writeLE16(uint8_t* dest, uint16_t value)
+{
+  dest[0] = (uint8_t)value;
+  dest[1] = (uint8_t)(value >> 8);
+}
+
+/* Function:  writeLE32
+ * ----------------------------------------
+ * write a 32-bit little endian value
+ */
+static inline void writeLE32(uint8_t* dest, uint32_t value)
+{
+  writeLE16(dest, (uint16_t)value);
+  writeLE16(dest + 2, (uint16_t)(value >> 16));
+}
+
+/* Function:  readLE16
+ * ----------------------------------------
+ * read a 16-bit little endian value
+ */
+static inline uint16_t readLE16(const uint8_t* src)
+{
+  return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+/* Function:  readLE32
+ * ----------------------------------------
+ * read a 32-bit little endian value
+ */
+static inline uint32_t readLE32(const uint8_t* src)
+{
+  return readLE16(src) | ((uint32_t)readLE16(src + 2) << 16);
+}
+
+
+/* Function:  vrEmuTms9918TraceNew
+ * ----------------------------------------
+ * start recording a trace of port activity on tms9918
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918Trace* vrEmuTms9918TraceNew(VrEmuTms9918* tms9918, const char* filename, uint32_t timeQuantum)
+{
+  if (tms9918 == NULL || filename == NULL)
+    return NULL;
+
+  VrEmuTms9918Trace* trace = (VrEmuTms9918Trace*)malloc(sizeof(VrEmuTms9918Trace));
+  if (trace == NULL)
+    return NULL;
+
+  trace->file = fopen(filename, "wb");
+  if (trace->file == NULL)
+  {
+    free(trace);
+    return NULL;
+  }
+
+  trace->tms9918 = tms9918;
+  trace->writeError = false;
+  trace->timeQuantum = timeQuantum ? timeQuantum : 1;
+  trace->recordedTime = 0;
+  trace->currentTime = 0;
+  trace->hasTime = false;
+  trace->pending = PENDING_NONE;
+  trace->pendingCount = 0;
+  trace->pendingY = 0;
+  trace->outBytes = 0;
+
+  /* header: current state of the tms9918 */
+  vrEmuTms9918PortState portState;
+  vrEmuTms9918GetPortState(tms9918, &portState);
+
+  uint8_t header[TRACE_HEADER_BYTES];
+  uint8_t* h = header;
+  memcpy(h, TRACE_MAGIC, TRACE_MAGIC_BYTES); h += TRACE_MAGIC_BYTES;
+  *h++ = TRACE_VERSION;
+  *h++ = 0;
+  writeLE32(h, trace->timeQuantum); h += 4;
+  const uint16_t vramSize = (uint16_t)vrEmuTms9918GetVramSize(tms9918);
+  writeLE16(h, vramSize); h += 2;
+  for (int i = 0; i < TMS_NUM_REGISTERS; ++i)
+  {
+    *h++ = vrEmuTms9918RegValue(tms9918, (vrEmuTms9918Register)i);
+  }
+  *h++ = portState.status;
+  *h++ = portState.regWriteStage;
+  *h++ = portState.regWriteStage0Value;
+  *h++ = portState.readAheadBuffer;
+  writeLE16(h, portState.currentAddress);
+
+  trace->writeError = fwrite(header, 1, sizeof(header), trace->file) != sizeof(header);
+
+  vrEmuTms9918ReadVram(tms9918, 0, trace->out, vramSize);
+  trace->outBytes = vramSize;
+  traceFlushOut(trace);
+
+  if (trace->writeError)
+  {
+    fclose(trace->file);
+    free(trace);
+    return NULL;
+  }
+
+  return trace;
+}
+
+/* Function:  vrEmuTms9918TraceDestroy
+ * ----------------------------------------
+ * flush and close a trace. returns false if any write failed
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918TraceDestroy(VrEmuTms9918Trace* trace)
+{
+  if (trace == NULL)
+    return true;
+
+  traceFlushPending(trace);
+  traceEmitByte(trace, TRACE_OP_END);
+  traceFlushOut(trace);
+
+  bool ok = !trace->writeError;
+  if (fclose(trace->file) != 0)
+  {
+    ok = false;
+  }
+  free(trace);
+  return ok;
+}
+
+/* Function:  vrEmuTms9918TraceSetTime
+ * ----------------------------------------
+ * set the current host time for subsequent calls
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TraceSetTime(VrEmuTms9918Trace* trace, uint64_t time)
+{
+  if (trace == NULL) return;
+
+  const uint64_t quanta = time / trace->timeQuantum;
+
+  /* the trace starts at the first time given */
+  if (!trace->hasTime)
+  {
+    trace->hasTime = true;
+    trace->recordedTime = trace->currentTime = quanta;
+  }
+  else if (quanta > trace->currentTime)
+  {
+    trace->currentTime = quanta;
+  }
+}
+
+/* Function:  vrEmuTms9918TraceWriteAddr
+ * ----------------------------------------
+ * vrEmuTms9918WriteAddr() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TraceWriteAddr(VrEmuTms9918Trace* trace, uint8_t data)
+{
+  if (trace == NULL) return;
+
+  traceBegin(trace, PENDING_NONE);
+  traceEmitByte(trace, TRACE_OP_WRITE_ADDR);
+  traceEmitByte(trace, data);
+
+  vrEmuTms9918WriteAddr(trace->tms9918, data);
+}
+
+/* Function:  vrEmuTms9918TraceWriteData
+ * ----------------------------------------
+ * vrEmuTms9918WriteData() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TraceWriteData(VrEmuTms9918Trace* trace, uint8_t data)
+{
+  if (trace == NULL) return;
+
+  if (traceBegin(trace, PENDING_DATA) && trace->pendingCount == TRACE_MAX_PENDING)
+  {
+    traceFlushPending(trace);
+    trace->pending = PENDING_DATA;
+  }
+  trace->pendingData[trace->pendingCount++] = data;
+
+  vrEmuTms9918WriteData(trace->tms9918, data);
+}
+
+/* Function:  vrEmuTms9918TraceReadStatus
+ * ----------------------------------------
+ * vrEmuTms9918ReadStatus() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918TraceReadStatus(VrEmuTms9918Trace* trace)
+{
+  if (trace == NULL) return 0;
+
+  traceCount(trace, PENDING_READ_STATUS);
+
+  return vrEmuTms9918ReadStatus(trace->tms9918);
+}
+
+/* Function:  vrEmuTms9918TraceReadData
+ * ----------------------------------------
+ * vrEmuTms9918ReadData() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918TraceReadData(VrEmuTms9918Trace* trace)
+{
+  if (trace == NULL) return 0;
+
+  traceCount(trace, PENDING_READ_DATA);
+
+  return vrEmuTms9918ReadData(trace->tms9918);
+}
+
+/* Function:  vrEmuTms9918TraceScanLine
+ * ----------------------------------------
+ * vrEmuTms9918ScanLine() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TraceScanLine(VrEmuTms9918Trace* trace, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  if (trace == NULL) return;
+
+  /* lines below the display only produce backdrop. nothing to record */
+  if (y >= TMS9918_PIXELS_Y)
+  {
+    vrEmuTms9918ScanLine(trace->tms9918, y, pixels);
+    return;
+  }
+
+  /* consecutive lines are recorded as a single range */
+  if (!traceBegin(trace, PENDING_SCANLINE))
+  {
+    trace->pendingY = y;
+  }
+  else if ((uint32_t)trace->pendingY + trace->pendingCount != y)
+  {
+    traceFlushPending(trace);
+    trace->pending = PENDING_SCANLINE;
+    trace->pendingY = y;
+  }
+  ++trace->pendingCount;
+
+  vrEmuTms9918ScanLine(trace->tms9918, y, pixels);
+}
+
+
+/* Function:  vrEmuTms9918TracePlayerNew
+ * ----------------------------------------
+ * load a trace into memory for replay
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918TracePlayer* vrEmuTms9918TracePlayerNew(const char* filename)
+{
+  if (filename == NULL)
+    return NULL;
+
+  FILE* file = fopen(filename, "rb");
+  if (file == NULL)
+    return NULL;
+
+  VrEmuTms9918TracePlayer* player = NULL;
+
+  if (fseek(file, 0, SEEK_END) == 0)
+  {
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (size >= TRACE_HEADER_BYTES)
+    {
+      player = (VrEmuTms9918TracePlayer*)malloc(sizeof(VrEmuTms9918TracePlayer));
+      if (player)
+      {
+        player->size = (size_t)size;
+        player->data = (uint8_t*)malloc(player->size);
+
+        if (player->data == NULL ||
+            fread(player->data, 1, player->size, file) != player->size ||
+            memcmp(player->data, TRACE_MAGIC, TRACE_MAGIC_BYTES) != 0 ||
+            player->data[TRACE_MAGIC_BYTES] != TRACE_VERSION ||
+            player->size < TRACE_HEADER_BYTES + (size_t)readLE16(player->data + TRACE_MAGIC_BYTES + 6))
+        {
+          vrEmuTms9918TracePlayerDestroy(player);
+          player = NULL;
+        }
+      }
+    }
+  }
+
+  fclose(file);
+
+  return player;
+}
+
+/* Function:  vrEmuTms9918TracePlayerDestroy
+ * ----------------------------------------
+ * free a loaded trace
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TracePlayerDestroy(VrEmuTms9918TracePlayer* player)
+{
+  if (player)
+  {
+    free(player->data);
+    free(player);
+  }
+}
+
+/* Function:  vrEmuTms9918TracePlayerVramSize
+ * ----------------------------------------
+ * vram size of the recorded instance
+ */
+VR_EMU_TMS9918_DLLEXPORT
+vrEmuTms9918VramSize vrEmuTms9918TracePlayerVramSize(VrEmuTms9918TracePlayer* player)
+{
+  if (player == NULL)
+    return TMS_VRAM_16K;
+
+  return (vrEmuTms9918VramSize)readLE16(player->data + TRACE_MAGIC_BYTES + 6);
+}
+
+/* Function:  readVarint
+ * ----------------------------------------
+ * read a LEB128 encoded value. returns false if truncated
+ */
+static inline bool readVarint(const uint8_t** pos, const uint8_t* end, uint64_t* value)
+{
+  uint64_t result = 0;
+  int shift = 0;
+
+  while (*pos < end && shift < 64)
+  {
+    const uint8_t b = *(*pos)++;
+    result |= (uint64_t)(b & 0x7f) << shift;
+    if ((b & 0x80) == 0)
+    {
+      *value = result;
+      return true;
+    }
+    shift += 7;
+  }
+  return false;
+}
+
+/* Function:  vrEmuTms9918TracePlay
+ * ----------------------------------------
+ * restore the recorded initial state and replay the whole trace
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918TracePlay(VrEmuTms9918TracePlayer* player, VrEmuTms9918* tms9918,
+                           vrEmuTms9918TraceScanLineFn scanLineFn, void* userData,
+                           vrEmuTms9918TraceStats* stats)
+{
+  if (player == NULL || tms9918 == NULL)
+    return false;
+
+  vrEmuTms9918TraceStats counts;
+  memset(&counts, 0, sizeof(counts));
+
+  /* restore initial state */
+  const uint8_t* h = player->data + TRACE_MAGIC_BYTES + 2;
+  const uint32_t timeQuantum = readLE32(h); h += 4;
+  const uint16_t vramSize = readLE16(h); h += 2;
+
+  for (int i = 0; i < TMS_NUM_REGISTERS; ++i)
+  {
+    vrEmuTms9918WriteRegValue(tms9918, (vrEmuTms9918Register)i, *h++);
+  }
+
+  vrEmuTms9918PortState portState;
+  portState.status = *h++;
+  portState.regWriteStage = *h++;
+  portState.regWriteStage0Value = *h++;
+  portState.readAheadBuffer = *h++;
+  portState.currentAddress = readLE16(h); h += 2;
+
+  vrEmuTms9918WriteVram(tms9918, 0, h, vramSize);
+  vrEmuTms9918SetPortState(tms9918, &portState);
+
+  /* replay */
+  const uint8_t* pos = h + vramSize;
+  const uint8_t* end = player->data + player->size;
+  uint8_t pixels[TMS9918_PIXELS_X];
+  uint64_t n = 0;
+  bool ok = false;
+
+  while (pos < end)
+  {
+    const uint8_t op = *pos++;
+
+    if (op == TRACE_OP_END)
+    {
+      ok = true;
+      break;
+    }
+
+    if (op == TRACE_OP_WRITE_ADDR)
+    {
+      if (pos >= end) break;
+      vrEmuTms9918WriteAddr(tms9918, *pos++);
+      ++counts.writeAddr;
+      continue;
+    }
+
+    if (op > TRACE_OP_SCANLINE || (op == TRACE_OP_SCANLINE && pos >= end))
+      break;
+
+    const uint8_t y = (op == TRACE_OP_SCANLINE) ? *pos++ : 0;
+
+    /* counts are recorded from 32-bit counters. lines must be on screen */
+    if (!readVarint(&pos, end, &n) || n > 0xffffffff ||
+        (op == TRACE_OP_SCANLINE && y + n > TMS9918_PIXELS_Y))
+      break;
+
+    switch (op)
+    {
+      case TRACE_OP_TIME:
+        counts.duration += n * timeQuantum;
+        break;
+
+      case TRACE_OP_WRITE_DATA:
+        if ((uint64_t)(end - pos) < n) { pos = end; break; }
+        for (uint64_t i = 0; i < n; ++i)
+        {
+          vrEmuTms9918WriteData(tms9918, *pos++);
+        }
+        counts.writeData += n;
+        break;
+
+      case TRACE_OP_WRITE_RUN:
+      {
+        if (pos >= end) break;
+        const uint8_t value = *pos++;
+        for (uint64_t i = 0; i < n; ++i)
+        {
+          vrEmuTms9918WriteData(tms9918, value);
+        }
+        counts.writeData += n;
+        break;
+      }
+
+      case TRACE_OP_READ_DATA:
+        for (uint64_t i = 0; i < n; ++i)
+        {
+          vrEmuTms9918ReadData(tms9918);
+        }
+        counts.readData += n;
+        break;
+
+      case TRACE_OP_READ_STATUS:
+        for (uint64_t i = 0; i < n; ++i)
+        {
+          vrEmuTms9918ReadStatus(tms9918);
+        }
+        counts.readStatus += n;
+        break;
+
+      case TRACE_OP_SCANLINE:
+        for (uint64_t i = 0; i < n; ++i)
+        {
+          const uint8_t line = (uint8_t)(y + i);
+          vrEmuTms9918ScanLine(tms9918, line, pixels);
+          if (scanLineFn)
+          {
+            scanLineFn(userData, line, pixels);
+          }
+        }
+        counts.scanLines += n;
+        break;
+    }
+  }
+
+  if (stats)
+  {
+    *stats = counts;
+  }
+
+  return ok;
+}
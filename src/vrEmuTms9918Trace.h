@@ -0,0 +1,174 @@
+/*
+ * Troy's TMS9918 Emulator - Port I/O trace recording / replay
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_TRACE_H_
+#define _VR_EMU_TMS9918_TRACE_H_
+
+#include "vrEmuTms9918.h"
+
+/* ------------------------------------------------------------------
+ * TRACE FORMAT (all multi-byte values little endian)
+ *
+ * header:
+ *   "TMS9918T"      magic
+ *   u8              version (1)
+ *   u8              reserved
+ *   u32             time quantum (host time units per recorded tick)
+ *   u16             vram size
+ *   u8[8]           registers
+ *   u8              status
+ *   u8              register write stage
+ *   u8              register write stage 0 value
+ *   u8              read-ahead buffer
+ *   u16             current address
+ *   u8[vram size]   vram
+ *
+ * records (opcode byte, then operands. counts are LEB128 varints):
+ *   0x00            end of trace
+ *   0x01 n          time advanced by n quanta
+ *   0x02 b          vrEmuTms9918WriteAddr(b)
+ *   0x03 n b[n]     vrEmuTms9918WriteData() x n (literal bytes)
+ *   0x04 n b        vrEmuTms9918WriteData(b) x n (run)
+ *   0x05 n          vrEmuTms9918ReadData() x n
+ *   0x06 n          vrEmuTms9918ReadStatus() x n
+ *   0x07 y n        vrEmuTms9918ScanLine() for lines y to y + n - 1
+ */
+
+/* PRIVATE DATA STRUCTURES
+ * ---------------------------------------- */
+struct vrEmuTms9918Trace_s;
+typedef struct vrEmuTms9918Trace_s VrEmuTms9918Trace;
+
+struct vrEmuTms9918TracePlayer_s;
+typedef struct vrEmuTms9918TracePlayer_s VrEmuTms9918TracePlayer;
+
+/* replay statistics */
+typedef struct
+{
+  uint64_t writeAddr;
+  uint64_t writeData;
+  uint64_t readData;
+  uint64_t readStatus;
+  uint64_t scanLines;
+  uint64_t duration;    /* recorded host time (host time units) */
+} vrEmuTms9918TraceStats;
+
+/* called for each scanline rendered during replay */
+typedef void (*vrEmuTms9918TraceScanLineFn)(void* userData, uint8_t y, const uint8_t pixels[TMS9918_PIXELS_X]);
+
+
+/* PUBLIC INTERFACE
+ * ---------------------------------------- */
+
+/* Function:  vrEmuTms9918TraceNew
+ * --------------------
+ * start recording a trace of port activity on tms9918
+ *
+ * the current state of tms9918 is written to the trace header, so
+ * recording can start at any time
+ *
+ * timeQuantum: host time units per recorded tick. time changes smaller
+ *              than this don't break up run-length encoded streams
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918Trace* vrEmuTms9918TraceNew(VrEmuTms9918* tms9918, const char* filename, uint32_t timeQuantum);
+
+/* Function:  vrEmuTms9918TraceDestroy
+ * --------------------
+ * flush and close a trace
+ *
+ * returns false if any write to the trace file (or closing it) failed,
+ * in which case the trace is incomplete
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918TraceDestroy(VrEmuTms9918Trace* trace);
+
+/* Function:  vrEmuTms9918TraceSetTime
+ * --------------------
+ * set the current host time (eg. cpu cycles) for subsequent calls
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TraceSetTime(VrEmuTms9918Trace* trace, uint64_t time);
+
+/* Function:  vrEmuTms9918TraceWriteAddr
+ * --------------------
+ * vrEmuTms9918WriteAddr() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TraceWriteAddr(VrEmuTms9918Trace* trace, uint8_t data);
+
+/* Function:  vrEmuTms9918TraceWriteData
+ * --------------------
+ * vrEmuTms9918WriteData() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TraceWriteData(VrEmuTms9918Trace* trace, uint8_t data);
+
+/* Function:  vrEmuTms9918TraceReadStatus
+ * --------------------
+ * vrEmuTms9918ReadStatus() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918TraceReadStatus(VrEmuTms9918Trace* trace);
+
+/* Function:  vrEmuTms9918TraceReadData
+ * --------------------
+ * vrEmuTms9918ReadData() and record it
+ */
+VR_EMU_TMS9918_DLLEXPORT
+uint8_t vrEmuTms9918TraceReadData(VrEmuTms9918Trace* trace);
+
+/* Function:  vrEmuTms9918TraceScanLine
+ * --------------------
+ * vrEmuTms9918ScanLine() and record it. lines below the display
+ * (y >= TMS9918_PIXELS_Y) are rendered but not recorded
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TraceScanLine(VrEmuTms9918Trace* trace, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X]);
+
+
+/* Function:  vrEmuTms9918TracePlayerNew
+ * --------------------
+ * load a trace into memory for replay. returns NULL if invalid
+ */
+VR_EMU_TMS9918_DLLEXPORT
+VrEmuTms9918TracePlayer* vrEmuTms9918TracePlayerNew(const char* filename);
+
+/* Function:  vrEmuTms9918TracePlayerDestroy
+ * --------------------
+ * free a loaded trace
+ */
+VR_EMU_TMS9918_DLLEXPORT
+void vrEmuTms9918TracePlayerDestroy(VrEmuTms9918TracePlayer* player);
+
+/* Function:  vrEmuTms9918TracePlayerVramSize
+ * --------------------
+ * vram size of the recorded instance
+ */
+VR_EMU_TMS9918_DLLEXPORT
+vrEmuTms9918VramSize vrEmuTms9918TracePlayerVramSize(VrEmuTms9918TracePlayer* player);
+
+/* Function:  vrEmuTms9918TracePlay
+ * --------------------
+ * restore the recorded initial state to tms9918 and replay the whole
+ * trace as fast as possible. tms9918 should have the recorded vram size
+ *
+ * scanLineFn: optional. called with each rendered scanline
+ * stats:      optional. receives operation counts
+ *
+ * returns false if the trace is truncated or corrupt
+ */
+VR_EMU_TMS9918_DLLEXPORT
+bool vrEmuTms9918TracePlay(VrEmuTms9918TracePlayer* player, VrEmuTms9918* tms9918,
+                           vrEmuTms9918TraceScanLineFn scanLineFn, void* userData,
+                           vrEmuTms9918TraceStats* stats);
+
+#endif // _VR_EMU_TMS9918_TRACE_H_
@@ -0,0 +1,181 @@
+/*
+ * Troy's TMS9918 Emulator - Frame delta encoding benchmark
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ * Replays a port I/O trace (see vrEmuTms9918Trace.h), delta encodes each
+ * rendered frame (see vrEmuTms9918Delta.h), decodes it again and checks
+ * the round trip. Reports stream size against raw frames and
+ * encode/decode times. The stream can be written out for archival.
+ *
+ * usage: vrEmuTms9918DeltaBench <trace file> [key frame interval] [stream file]
+ */
+
+#include "vrEmuTms9918Trace.h"
+#include "vrEmuTms9918Delta.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FRAME_PIXELS    (TMS9918_PIXELS_X * TMS9918_PIXELS_Y)
+
+typedef struct
+{
+  uint8_t frame[FRAME_PIXELS];
+  uint8_t prevFrame[FRAME_PIXELS];
+  uint8_t decoded[FRAME_PIXELS];
+  uint8_t encoded[TMS_DELTA_MAX_FRAME_BYTES];
+
+  long keyInterval;
+  FILE* stream;
+
+  long frames;
+  long keyFrames;
+  long mismatches;
+  uint64_t encodedBytes;
+  size_t maxFrameBytes;
+  double encodeSeconds;
+  double decodeSeconds;
+} DeltaBench;
+
+/* Function:  nowSeconds
+ * ----------------------------------------
+ * wall clock time in seconds
+ */
+static double nowSeconds(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Function:  frameComplete
+ * ----------------------------------------
+ * encode, decode and verify a frame
+ */
+static void frameComplete(DeltaBench* bench)
+{
+  const bool key = bench->frames == 0 || (bench->keyInterval > 0 && bench->frames % bench->keyInterval == 0);
+
+  double start = nowSeconds();
+  const size_t bytes = vrEmuTms9918DeltaEncode(key ? NULL : bench->prevFrame, bench->frame,
+                                               bench->encoded, sizeof(bench->encoded));
+  bench->encodeSeconds += nowSeconds() - start;
+
+  start = nowSeconds();
+  const size_t consumed = vrEmuTms9918DeltaDecode(bench->encoded, bytes, bench->decoded);
+  bench->decodeSeconds += nowSeconds() - start;
+
+  if (consumed != bytes || memcmp(bench->decoded, bench->frame, FRAME_PIXELS) != 0)
+  {
+    ++bench->mismatches;
+  }
+
+  if (bench->stream)
+  {
+    fwrite(bench->encoded, 1, bytes, bench->stream);
+  }
+
+  ++bench->frames;
+  bench->keyFrames += key;
+  bench->encodedBytes += bytes;
+  if (bytes > bench->maxFrameBytes) bench->maxFrameBytes = bytes;
+
+  memcpy(bench->prevFrame, bench->frame, FRAME_PIXELS);
+}
+
+/* Function:  scanLineFn
+ * ----------------------------------------
+ * collect replayed scanlines into frames
+ */
+static void scanLineFn(void* userData, uint8_t y, const uint8_t pixels[TMS9918_PIXELS_X])
+{
+  DeltaBench* bench = (DeltaBench*)userData;
+  memcpy(bench->frame + y * TMS9918_PIXELS_X, pixels, TMS9918_PIXELS_X);
+
+  if (y == TMS9918_PIXELS_Y - 1)
+  {
+    frameComplete(bench);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: %s <trace file> [key frame interval] [stream file]\n", argv[0]);
+    return 1;
+  }
+
+  static DeltaBench bench;
+  bench.keyInterval = (argc > 2) ? atol(argv[2]) : 300;
+
+  VrEmuTms9918TracePlayer* player = vrEmuTms9918TracePlayerNew(argv[1]);
+  if (player == NULL)
+  {
+    fprintf(stderr, "unable to load trace: %s\n", argv[1]);
+    return 1;
+  }
+
+  if (argc > 3)
+  {
+    bench.stream = fopen(argv[3], "wb");
+    if (bench.stream == NULL)
+    {
+      fprintf(stderr, "unable to open stream file: %s\n", argv[3]);
+      vrEmuTms9918TracePlayerDestroy(player);
+      return 1;
+    }
+  }
+
+  VrEmuTms9918* tms9918 = vrEmuTms9918NewWithVram(vrEmuTms9918TracePlayerVramSize(player));
+  if (tms9918 == NULL)
+  {
+    fprintf(stderr, "unable to create tms9918\n");
+    if (bench.stream)
+    {
+      fclose(bench.stream);
+    }
+    vrEmuTms9918TracePlayerDestroy(player);
+    return 1;
+  }
+
+  if (!vrEmuTms9918TracePlay(player, tms9918, scanLineFn, &bench, NULL))
+  {
+    fprintf(stderr, "warning: trace is truncated or corrupt. replaying valid portion\n");
+  }
+
+  if (bench.stream && fclose(bench.stream) != 0)
+  {
+    fprintf(stderr, "unable to write stream file: %s\n", argv[3]);
+  }
+
+  const uint64_t rawBytes = (uint64_t)bench.frames * FRAME_PIXELS;
+
+  printf("trace:          %s\n", argv[1]);
+  printf("frames:         %ld (%ld key frames)\n", bench.frames, bench.keyFrames);
+  printf("raw bytes:      %llu (%llu at 4bpp)\n", (unsigned long long)rawBytes, (unsigned long long)rawBytes / 2);
+  printf("encoded bytes:  %llu\n", (unsigned long long)bench.encodedBytes);
+  printf("round trip:     %s (%ld mismatched frames)\n", bench.mismatches ? "FAILED" : "ok", bench.mismatches);
+
+  if (bench.frames)
+  {
+    printf("bytes/frame:    %.1f avg, %llu max\n", (double)bench.encodedBytes / bench.frames,
+           (unsigned long long)bench.maxFrameBytes);
+    printf("ratio:          %.1f:1 (%.1f:1 vs 4bpp)\n", (double)rawBytes / (double)bench.encodedBytes,
+           (double)rawBytes / 2.0 / (double)bench.encodedBytes);
+    printf("encode:         %.2f us/frame\n", bench.encodeSeconds / bench.frames * 1e6);
+    printf("decode:         %.2f us/frame\n", bench.decodeSeconds / bench.frames * 1e6);
+  }
+
+  vrEmuTms9918Destroy(tms9918);
+  vrEmuTms9918TracePlayerDestroy(player);
+
+  return bench.mismatches ? 1 : 0;
+}
@@ -0,0 +1,574 @@
+/*
+ * Troy's TMS9918 Emulator - Frozen reference renderer
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ * DO NOT OPTIMIZE OR REFACTOR. This is a frozen copy of the scalar
+ * scanline renderer in src/vrEmuTms9918.c as of October 2026, retargeted
+ * to a standalone state structure (profiler hooks and the interrupt
+ * callback removed). vrEmuTms9918Verify checks optimized render paths
+ * against it. It is changed only for intentional behavior changes (see
+ * git log).
+ */
+
+#include "vrEmuTms9918Reference.h"
+
+#include <string.h>
+
+#define VRAM_SIZE           (1 << 14) /* 16KB (maximum) */
+#define VRAM_MASK     (VRAM_SIZE - 1) /* 0x3fff */
+
+#define GRAPHICS_NUM_COLS         32
+#define GRAPHICS_NUM_ROWS         24
+#define GRAPHICS_CHAR_WIDTH        8
+
+#define TEXT_NUM_COLS             40
+#define TEXT_NUM_ROWS             24
+#define TEXT_CHAR_WIDTH            6
+#define TEXT_PADDING_PX            8
+
+#define PATTERN_BYTES              8
+#define GFXI_COLOR_GROUP_SIZE      8
+
+#define MAX_SPRITES               32
+
+#define SPRITE_ATTR_Y              0
+#define SPRITE_ATTR_X              1
+#define SPRITE_ATTR_NAME           2
+#define SPRITE_ATTR_COLOR          3
+#define SPRITE_ATTR_BYTES          4
+#define LAST_SPRITE_YPOS        0xD0
+#define MAX_SCANLINE_SPRITES       4
+
+#define STATUS_INT              0x80
+#define STATUS_5S               0x40
+#define STATUS_COL              0x20
+
+#define TMS_R0_MODE_GRAPHICS_II 0x02
+#define TMS_R0_EXT_VDP_ENABLE   0x01
+
+#define TMS_R1_DISP_ACTIVE      0x40
+#define TMS_R1_INT_ENABLE       0x20
+#define TMS_R1_MODE_MULTICOLOR  0x08
+#define TMS_R1_MODE_TEXT        0x10
+#define TMS_R1_SPRITE_16        0x02
+#define TMS_R1_SPRITE_MAG2      0x01
+
+
+/* Function:  tmsMode
+ * ----------------------------------------
+ * return the current display mode
+ */
+static vrEmuTms9918Mode tmsMode(vrEmuTms9918Reference* tms9918)
+{
+  if (tms9918->registers[TMS_REG_0] & TMS_R0_MODE_GRAPHICS_II)
+  {
+    return TMS_MODE_GRAPHICS_II;
+  }
+
+  /* MC and TEX bits 3 and 4. Shift to bits 0 and 1 to determine a value (0, 1 or 2) */
+  switch ((tms9918->registers[TMS_REG_1] & (TMS_R1_MODE_MULTICOLOR | TMS_R1_MODE_TEXT)) >> 3)
+  {
+    case 0:
+      return TMS_MODE_GRAPHICS_I;
+
+    case 1:
+      return TMS_MODE_MULTICOLOR;
+
+    case 2:
+      return TMS_MODE_TEXT;
+  }
+  return TMS_MODE_GRAPHICS_I;
+}
+
+
+/* Function:  tmsSpriteSize
+ * ----------------------------------------
+ * sprite size (8 or 16)
+ */
+static inline uint8_t tmsSpriteSize(vrEmuTms9918Reference* tms9918)
+{
+  return tms9918->registers[TMS_REG_1] & TMS_R1_SPRITE_16 ? 16 : 8;
+}
+
+/* Function:  tmsSpriteMagnification
+ * ----------------------------------------
+ * sprite size (0 = 1x, 1 = 2x)
+ */
+static inline bool tmsSpriteMag(vrEmuTms9918Reference* tms9918)
+{
+  return tms9918->registers[TMS_REG_1] & TMS_R1_SPRITE_MAG2;
+}
+
+/* Function:  tmsNameTableAddr
+ * ----------------------------------------
+ * name table base address
+ */
+static inline uint16_t tmsNameTableAddr(vrEmuTms9918Reference* tms9918)
+{
+  return ((tms9918->registers[TMS_REG_NAME_TABLE] & 0x0f) << 10) & tms9918->vramMask;
+}
+
+/* Function:  tmsColorTableAddr
+ * ----------------------------------------
+ * color table base address
+ */
+static inline uint16_t tmsColorTableAddr(vrEmuTms9918Reference* tms9918)
+{
+  const uint8_t mask = (tms9918->mode == TMS_MODE_GRAPHICS_II) ? 0x80 : 0xff;
+
+  return ((tms9918->registers[TMS_REG_COLOR_TABLE] & mask) << 6) & tms9918->vramMask;
+}
+
+/* Function:  tmsPatternTableAddr
+ * ----------------------------------------
+ * pattern table base address
+ */
+static inline uint16_t tmsPatternTableAddr(vrEmuTms9918Reference* tms9918)
+{
+  const uint8_t mask = (tms9918->mode == TMS_MODE_GRAPHICS_II) ? 0x04 : 0x07;
+
+  return ((tms9918->registers[TMS_REG_PATTERN_TABLE] & mask) << 11) & tms9918->vramMask;
+}
+
+/* Function:  tmsSpriteAttrTableAddr
+ * ----------------------------------------
+ * sprite attribute table base address
+ */
+static inline uint16_t tmsSpriteAttrTableAddr(vrEmuTms9918Reference* tms9918)
+{
+  return ((tms9918->registers[TMS_REG_SPRITE_ATTR_TABLE] & 0x7f) << 7) & tms9918->vramMask;
+}
+
+/* Function:  tmsSpritePatternTableAddr
+ * ----------------------------------------
+ * sprite pattern table base address
+ */
+static inline uint16_t tmsSpritePatternTableAddr(vrEmuTms9918Reference* tms9918)
+{
+  return ((tms9918->registers[TMS_REG_SPRITE_PATT_TABLE] & 0x07) << 11) & tms9918->vramMask;
+}
+
+/* Function:  tmsBgColor
+ * ----------------------------------------
+ * background color
+ */
+static inline vrEmuTms9918Color tmsMainBgColor(vrEmuTms9918Reference* tms9918)
+{
+  return tms9918->registers[TMS_REG_FG_BG_COLOR] & 0x0f;
+}
+
+/* Function:  tmsFgColor
+ * ----------------------------------------
+ * foreground color
+ */
+static inline vrEmuTms9918Color tmsMainFgColor(vrEmuTms9918Reference* tms9918)
+{
+  const vrEmuTms9918Color c = (vrEmuTms9918Color)(tms9918->registers[TMS_REG_FG_BG_COLOR] >> 4);
+  return c == TMS_TRANSPARENT ? tmsMainBgColor(tms9918) : c;
+}
+
+/* Function:  tmsFgColor
+ * ----------------------------------------
+ * foreground color
+ */
+static inline vrEmuTms9918Color tmsFgColor(vrEmuTms9918Reference* tms9918, uint8_t colorByte)
+{
+  const vrEmuTms9918Color c = (vrEmuTms9918Color)(colorByte >> 4);
+  return c == TMS_TRANSPARENT ? tmsMainBgColor(tms9918) : c;
+}
+
+/* Function:  tmsBgColor
+ * ----------------------------------------
+ * background color
+ */
+static inline vrEmuTms9918Color tmsBgColor(vrEmuTms9918Reference* tms9918, uint8_t colorByte)
+{
+  const vrEmuTms9918Color c = (vrEmuTms9918Color)(colorByte & 0x0f);
+  return c == TMS_TRANSPARENT ? tmsMainBgColor(tms9918) : c;
+}
+
+
+/* Function:  tmsUpdateInt
+ * ----------------------------------------
+ * update the INT output
+ */
+static inline void tmsUpdateInt(vrEmuTms9918Reference* tms9918)
+{
+  const bool active = (tms9918->status & STATUS_INT) && (tms9918->registers[TMS_REG_1] & TMS_R1_INT_ENABLE);
+  if (active != tms9918->intActive)
+  {
+    tms9918->intActive = active;
+  }
+}
+
+/* Function:  vrEmuTms9918OutputSprites
+ * ----------------------------------------
+ * Output Sprites to a scanline
+ */
+static void vrEmuTms9918OutputSprites(vrEmuTms9918Reference* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  const bool spriteMag = tmsSpriteMag(tms9918);
+  const bool sprite16 = tmsSpriteSize(tms9918) == 16;
+  const uint8_t spriteSize = tmsSpriteSize(tms9918);
+  const uint8_t spriteSizePx = spriteSize * (spriteMag + 1);
+  const uint16_t spriteAttrTableAddr = tmsSpriteAttrTableAddr(tms9918);
+  const uint16_t spritePatternAddr = tmsSpritePatternTableAddr(tms9918);
+  const uint8_t* vram = tms9918->vram;
+  const uint16_t vramMask = tms9918->vramMask;
+
+  uint8_t spritesShown = 0;
+
+  if (y == 0)
+  {
+    tms9918->status = 0;
+  }
+
+  const uint8_t* spriteAttr = vram + spriteAttrTableAddr;
+  for (uint8_t spriteIdx = 0; spriteIdx < MAX_SPRITES; ++spriteIdx)
+  {
+    int16_t yPos = spriteAttr[SPRITE_ATTR_Y];
+
+    /* stop processing when yPos == LAST_SPRITE_YPOS */
+    if (yPos == LAST_SPRITE_YPOS)
+    {
+      if ((tms9918->status & STATUS_5S) == 0)
+      {
+        tms9918->status |= spriteIdx;
+      }
+      break;
+    }
+
+    /* check if sprite position is in the -31 to 0 range and move back to top */
+    if (yPos > 0xe0)
+    {
+      yPos -= 256;
+    }
+
+    /* first row is YPOS -1 (0xff). 2nd row is YPOS 0 */
+    yPos += 1;
+
+    int16_t pattRow = y - yPos;
+    if (spriteMag)
+    {
+      pattRow >>= 1;  // this needs to be a shift because -1 / 2 becomes 0. Bad.
+    }
+
+    /* check if sprite is visible on this line */
+    if (pattRow < 0 || pattRow >= spriteSize)
+    {
+      spriteAttr += SPRITE_ATTR_BYTES;
+      continue;
+    }
+
+    if (spritesShown == 0)
+    {
+      int* rsbInt = (int*)tms9918->rowSpriteBits;
+      int* end = rsbInt + sizeof(tms9918->rowSpriteBits) / sizeof(int);
+
+      while (rsbInt < end)
+      {
+        *rsbInt++ = 0;
+      }
+    }
+
+    const uint8_t spriteColor = spriteAttr[SPRITE_ATTR_COLOR] & 0x0f;
+
+    /* have we exceeded the scanline sprite limit? */
+    if (++spritesShown > MAX_SCANLINE_SPRITES)
+    {
+      if ((tms9918->status & STATUS_5S) == 0)
+      {
+        tms9918->status |= STATUS_5S | spriteIdx;
+      }
+      break;
+    }
+
+    /* sprite is visible on this line */
+    const uint8_t pattIdx = spriteAttr[SPRITE_ATTR_NAME];
+    const uint16_t pattOffset = spritePatternAddr + pattIdx * PATTERN_BYTES + (uint16_t)pattRow;
+
+    const int16_t earlyClockOffset = (spriteAttr[SPRITE_ATTR_COLOR] & 0x80) ? -32 : 0;
+    const int16_t xPos = (int16_t)(spriteAttr[SPRITE_ATTR_X]) + earlyClockOffset;
+
+    int8_t pattByte = vram[pattOffset & vramMask];
+    uint8_t screenBit = 0, pattBit = 0;
+
+    int16_t endXPos = xPos + spriteSizePx;
+    if (endXPos >= TMS9918_PIXELS_X)
+    {
+      endXPos = TMS9918_PIXELS_X;
+    }
+
+    for (int16_t screenX = xPos; screenX < endXPos; ++screenX, ++screenBit)
+    {
+      if (screenX >= 0)
+      {
+        if (pattByte < 0)
+        {
+          if (spriteColor != TMS_TRANSPARENT && tms9918->rowSpriteBits[screenX] < 2)
+          {
+            pixels[screenX] = spriteColor;
+          }
+
+          /* we still process transparent sprites, since
+             they're used in 5S and collision checks */
+          if (tms9918->rowSpriteBits[screenX])
+          {
+            tms9918->status |= STATUS_COL;
+          }
+          else
+          {
+            tms9918->rowSpriteBits[screenX] = spriteColor + 1;
+          }
+        }
+      }
+
+      /* next pattern bit if non-magnified or if odd screen bit */
+      if (!spriteMag || (screenBit & 0x01))
+      {
+        pattByte <<= 1;
+        if (++pattBit == GRAPHICS_CHAR_WIDTH && sprite16) /* from A -> C or B -> D of large sprite */
+        {
+          pattBit = 0;
+          pattByte = vram[(pattOffset + PATTERN_BYTES * 2) & vramMask];
+        }
+      }
+    }
+    spriteAttr += SPRITE_ATTR_BYTES;
+  }
+
+}
+
+
+/* Function:  vrEmuTms9918GraphicsIScanLine
+ * ----------------------------------------
+ * generate a Graphics I mode scanline
+ */
+static void vrEmuTms9918GraphicsIScanLine(vrEmuTms9918Reference* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  const uint8_t tileY = y >> 3;   /* which name table row (0 - 23) */
+  const uint8_t pattRow = y & 0x07;  /* which pattern row (0 - 7) */
+  const uint8_t* vram = tms9918->vram;
+
+  /* address in name table at the start of this row */
+  const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+  const uint8_t* colorTable = vram + tmsColorTableAddr(tms9918);
+
+  /* iterate over each tile in this row */
+  for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
+  {
+    const uint8_t pattIdx = vram[rowNamesAddr + tileX];
+    uint8_t pattByte = patternTable[pattIdx * PATTERN_BYTES + pattRow];
+    const uint8_t colorByte = colorTable[pattIdx / GFXI_COLOR_GROUP_SIZE];
+
+
+    const uint8_t fgColor = tmsFgColor(tms9918, colorByte);
+    const uint8_t bgColor = tmsBgColor(tms9918, colorByte);
+
+    /* iterate over each bit of this pattern byte */
+    for (uint8_t pattBit = 0; pattBit < GRAPHICS_CHAR_WIDTH; ++pattBit)
+    {
+      const bool pixelBit = pattByte & 0x80;
+      *(pixels++) = pixelBit ? fgColor : bgColor;
+      pattByte <<= 1;
+    }
+  }
+
+  vrEmuTms9918OutputSprites(tms9918, y, pixels - TMS9918_PIXELS_X);
+}
+
+/* Function:  vrEmuTms9918GraphicsIIScanLine
+ * ----------------------------------------
+ * generate a Graphics II mode scanline
+ */
+static void vrEmuTms9918GraphicsIIScanLine(vrEmuTms9918Reference* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  const uint8_t tileY = y >> 3;   /* which name table row (0 - 23) */
+  const uint8_t pattRow = y & 0x07;  /* which pattern row (0 - 7) */
+  const uint8_t* vram = tms9918->vram;
+
+  /* address in name table at the start of this row */
+  const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+
+  /* the datasheet says the lower bits of the color and pattern tables must
+     be all 1's for graphics II mode. however, the lowest 2 bits of the
+     pattern address are used to determine if pages 2 & 3 come from page 0
+     or not. Similarly, the lowest 6 bits of the color table register are
+     used as an and mask with the nametable  index */
+  const uint8_t nameMask = ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x7f) << 3) | 0x07;
+
+  const uint16_t pageThird = ((tileY & 0x18) >> 3)
+    & (tms9918->registers[TMS_REG_PATTERN_TABLE] & 0x03); /* which page? 0-2 */
+  const uint16_t pageOffset = pageThird << 11; /* offset (0, 0x800 or 0x1000) */
+
+  const uint8_t* patternTable = vram + ((tmsPatternTableAddr(tms9918) + pageOffset) & tms9918->vramMask);
+  const uint8_t* colorTable = vram + ((tmsColorTableAddr(tms9918) + (pageOffset
+    & ((tms9918->registers[TMS_REG_COLOR_TABLE] & 0x60) << 6))) & tms9918->vramMask);
+
+  /* iterate over each tile in this row */
+  for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
+  {
+    uint8_t pattIdx = vram[rowNamesAddr + tileX] & nameMask;
+
+    const size_t pattRowOffset = pattIdx * PATTERN_BYTES + pattRow;
+    const uint8_t pattByte = patternTable[pattRowOffset];
+    const uint8_t colorByte = colorTable[pattRowOffset];
+
+
+    const vrEmuTms9918Color fgColor = tmsFgColor(tms9918, colorByte);
+    const vrEmuTms9918Color bgColor = tmsBgColor(tms9918, colorByte);
+
+    /* iterate over each bit of this pattern byte */
+    for (uint8_t pattBit = 0; pattBit < GRAPHICS_CHAR_WIDTH; ++pattBit)
+    {
+      const bool pixelBit = (pattByte << pattBit) & 0x80;
+      pixels[tileX * GRAPHICS_CHAR_WIDTH + pattBit] = (uint8_t)(pixelBit ? fgColor : bgColor);
+    }
+  }
+
+  vrEmuTms9918OutputSprites(tms9918, y, pixels);
+}
+
+/* Function:  vrEmuTms9918TextScanLine
+ * ----------------------------------------
+ * generate a Text mode scanline
+ */
+static void vrEmuTms9918TextScanLine(vrEmuTms9918Reference* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  const uint8_t tileY = y >> 3;   /* which name table row (0 - 23) */
+  const uint8_t pattRow = y & 0x07;  /* which pattern row (0 - 7) */
+  const uint8_t* vram = tms9918->vram;
+
+  /* address in name table at the start of this row */
+  const uint16_t rowNamesAddr = tmsNameTableAddr(tms9918) + tileY * TEXT_NUM_COLS;
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+
+  const vrEmuTms9918Color bgColor = tmsMainBgColor(tms9918);
+  const vrEmuTms9918Color fgColor = tmsMainFgColor(tms9918);
+
+  /* fill the first and last 8 pixels with bg color */
+  memset(pixels, bgColor, TEXT_PADDING_PX);
+  memset(pixels + TMS9918_PIXELS_X - TEXT_PADDING_PX, bgColor, TEXT_PADDING_PX);
+
+  for (uint8_t tileX = 0; tileX < TEXT_NUM_COLS; ++tileX)
+  {
+    const uint8_t pattIdx = vram[rowNamesAddr + tileX];
+    const uint8_t pattByte = patternTable[pattIdx * PATTERN_BYTES + pattRow];
+
+
+    for (uint8_t pattBit = 0; pattBit < TEXT_CHAR_WIDTH; ++pattBit)
+    {
+      bool pixelBit = (pattByte << pattBit) & 0x80;
+      pixels[TEXT_PADDING_PX + tileX * TEXT_CHAR_WIDTH + pattBit] = (uint8_t)(pixelBit ? fgColor : bgColor);
+    }
+  }
+}
+
+/* Function:  vrEmuTms9918MulticolorScanLine
+ * ----------------------------------------
+ * generate a Multicolor mode scanline
+ */
+static void vrEmuTms9918MulticolorScanLine(vrEmuTms9918Reference* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  const uint8_t tileY = y >> 3;
+  const uint8_t pattRow = ((y / 4) & 0x01) + (tileY & 0x03) * 2;
+  const uint8_t* vram = tms9918->vram;
+
+  const uint16_t namesAddr = tmsNameTableAddr(tms9918) + tileY * GRAPHICS_NUM_COLS;
+  const uint8_t* patternTable = vram + tmsPatternTableAddr(tms9918);
+
+  for (uint8_t tileX = 0; tileX < GRAPHICS_NUM_COLS; ++tileX)
+  {
+    const uint8_t pattIdx = vram[namesAddr + tileX];
+    const uint8_t colorByte = patternTable[pattIdx * PATTERN_BYTES + pattRow];
+
+
+    memset(pixels + tileX * 8, tmsFgColor(tms9918, colorByte), 4);
+    memset(pixels + tileX * 8 + 4, tmsBgColor(tms9918, colorByte), 4);
+  }
+
+  vrEmuTms9918OutputSprites(tms9918, y, pixels);
+}
+
+
+/* Function:  tmsScanLineEnd
+ * ----------------------------------------
+ * end of a rendered scanline. update the INT flag
+ */
+static inline void tmsScanLineEnd(vrEmuTms9918Reference* tms9918, uint8_t y)
+{
+  if (y == TMS9918_PIXELS_Y - 1 && (tms9918->registers[1] & TMS_R1_INT_ENABLE))
+  {
+    tms9918->status |= STATUS_INT;
+  }
+
+  /* status is reset on line 0 and INT raised on the last line */
+  if (y == 0 || y == TMS9918_PIXELS_Y - 1)
+  {
+    tmsUpdateInt(tms9918);
+  }
+}
+
+/* Function:  vrEmuTms9918ReferenceScanLine
+ * ----------------------------------------
+ * generate a scanline
+ */
+void vrEmuTms9918ReferenceScanLine(vrEmuTms9918Reference* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X])
+{
+  if (tms9918 == NULL)
+    return;
+
+  if (!(tms9918->registers[TMS_REG_1] & TMS_R1_DISP_ACTIVE) || y >= TMS9918_PIXELS_Y)
+  {
+    memset(pixels, tmsMainBgColor(tms9918), TMS9918_PIXELS_X);
+    if (y < TMS9918_PIXELS_Y)
+    {
+      tmsScanLineEnd(tms9918, y);
+    }
+    return;
+  }
+
+  switch (tms9918->mode)
+  {
+    case TMS_MODE_GRAPHICS_I:
+      vrEmuTms9918GraphicsIScanLine(tms9918, y, pixels);
+      break;
+
+    case TMS_MODE_GRAPHICS_II:
+      vrEmuTms9918GraphicsIIScanLine(tms9918, y, pixels);
+      break;
+
+    case TMS_MODE_TEXT:
+      vrEmuTms9918TextScanLine(tms9918, y, pixels);
+      break;
+
+    case TMS_MODE_MULTICOLOR:
+      vrEmuTms9918MulticolorScanLine(tms9918, y, pixels);
+      break;
+  }
+
+  tmsScanLineEnd(tms9918, y);
+}
+
+/* Function:  vrEmuTms9918ReferenceLoad
+ * ----------------------------------------
+ * load a state
+ */
+void vrEmuTms9918ReferenceLoad(vrEmuTms9918Reference* tms9918, const uint8_t registers[TMS_NUM_REGISTERS],
+                               uint8_t status, const uint8_t vram[TMS_VRAM_16K])
+{
+  memcpy(tms9918->registers, registers, TMS_NUM_REGISTERS);
+  memcpy(tms9918->vram, vram, TMS_VRAM_16K);
+  memset(tms9918->rowSpriteBits, 0, sizeof(tms9918->rowSpriteBits));
+  tms9918->vramMask = TMS_VRAM_16K - 1;
+  tms9918->mode = tmsMode(tms9918);
+  tms9918->status = status;
+  tms9918->intActive = (status & STATUS_INT) && (registers[TMS_REG_1] & TMS_R1_INT_ENABLE);
+}
@@ -0,0 +1,44 @@
+/*
+ * Troy's TMS9918 Emulator - Frozen reference renderer
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ */
+
+#ifndef _VR_EMU_TMS9918_REFERENCE_H_
+#define _VR_EMU_TMS9918_REFERENCE_H_
+
+#include "vrEmuTms9918.h"
+
+/* render state of the reference renderer (16KB vram only) */
+typedef struct
+{
+  /* first: accessed as ints */
+  uint8_t rowSpriteBits[TMS9918_PIXELS_X];
+  uint8_t vram[TMS_VRAM_16K];
+
+  uint8_t registers[TMS_NUM_REGISTERS];
+  uint8_t status;
+  vrEmuTms9918Mode mode;
+  uint16_t vramMask;
+  bool intActive;
+} vrEmuTms9918Reference;
+
+/* Function:  vrEmuTms9918ReferenceLoad
+ * --------------------
+ * load registers, status and vram
+ */
+void vrEmuTms9918ReferenceLoad(vrEmuTms9918Reference* tms9918, const uint8_t registers[TMS_NUM_REGISTERS],
+                               uint8_t status, const uint8_t vram[TMS_VRAM_16K]);
+
+/* Function:  vrEmuTms9918ReferenceScanLine
+ * --------------------
+ * generate a scanline exactly as vrEmuTms9918ScanLine did when frozen
+ */
+void vrEmuTms9918ReferenceScanLine(vrEmuTms9918Reference* tms9918, uint8_t y, uint8_t pixels[TMS9918_PIXELS_X]);
+
+#endif // _VR_EMU_TMS9918_REFERENCE_H_
@@ -0,0 +1,608 @@
+/*
+ * Troy's TMS9918 Emulator - Batch VRAM dump renderer
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ * Renders VRAM dumps (16KB VRAM followed by the 8 registers. see
+ * pybindings/image.bin) to image files using all available cores.
+ *
+ * usage: vrEmuTms9918Render [-f ppm|png|raw] [-o outdir] [-j threads] dump...
+ */
+
+#include "vrEmuTms9918.h"
+#include "vrEmuTms9918Util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define DUMP_VRAM_BYTES   0x4000
+#define DUMP_BYTES        (DUMP_VRAM_BYTES + TMS_NUM_REGISTERS)
+#define FRAME_PIXELS      (TMS9918_PIXELS_X * TMS9918_PIXELS_Y)
+#define PALETTE_SIZE      16
+#define MAX_THREADS       256
+
+#define PNG_ROW_BYTES     (TMS9918_PIXELS_X + 1)
+#define PNG_RAW_BYTES     (PNG_ROW_BYTES * TMS9918_PIXELS_Y)
+#define PNG_IDAT_BYTES    (2 + 5 + PNG_RAW_BYTES + 4)
+
+typedef enum
+{
+  FORMAT_PPM,
+  FORMAT_PNG,
+  FORMAT_RAW,
+} OutputFormat;
+
+/* shared job state */
+typedef struct
+{
+  char** inputs;
+  int numInputs;
+  const char* outDir;
+  OutputFormat format;
+  volatile long nextInput;
+} Job;
+
+/* per-thread state */
+typedef struct
+{
+  Job* job;
+  int rendered;
+  int failed;
+  double renderSeconds;
+  uint8_t frame[FRAME_PIXELS];
+  uint8_t rgb[FRAME_PIXELS * 3];
+  uint8_t idat[PNG_IDAT_BYTES];
+} Worker;
+
+/* Function:  nowSeconds
+ * ----------------------------------------
+ * wall clock time in seconds
+ */
+static double nowSeconds(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Function:  claimInput
+ * ----------------------------------------
+ * claim the next input index (thread safe)
+ */
+static long claimInput(Job* job)
+{
+#ifdef _WIN32
+  return InterlockedIncrement(&job->nextInput) - 1;
+#else
+  return __atomic_fetch_add(&job->nextInput, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+/* Function:  numCores
+ * ----------------------------------------
+ * number of online processors
+ */
+static int numCores(void)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (int)info.dwNumberOfProcessors;
+#else
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+#endif
+}
+
+
+/* MEMORY MAPPED INPUT
+ * ---------------------------------------- */
+typedef struct
+{
+  const uint8_t* data;
+  size_t size;
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#endif
+} MappedFile;
+
+/* Function:  mapFile
+ * ----------------------------------------
+ * map a file read-only. returns false on failure
+ */
+static bool mapFile(const char* filename, MappedFile* mf)
+{
+  mf->data = NULL;
+  mf->size = 0;
+
+#ifdef _WIN32
+  mf->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (mf->file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(mf->file, &size) || size.QuadPart == 0)
+  {
+    CloseHandle(mf->file);
+    return false;
+  }
+
+  mf->mapping = CreateFileMappingA(mf->file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mf->mapping == NULL)
+  {
+    CloseHandle(mf->file);
+    return false;
+  }
+
+  mf->data = (const uint8_t*)MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0);
+  if (mf->data == NULL)
+  {
+    CloseHandle(mf->mapping);
+    CloseHandle(mf->file);
+    return false;
+  }
+  mf->size = (size_t)size.QuadPart;
+#else
+  const int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  mf->data = (const uint8_t*)data;
+  mf->size = (size_t)st.st_size;
+#endif
+  return true;
+}
+
+/* Function:  unmapFile
+ * ----------------------------------------
+ * unmap a file mapped with mapFile()
+ */
+static void unmapFile(MappedFile* mf)
+{
+#ifdef _WIN32
+  UnmapViewOfFile(mf->data);
+  CloseHandle(mf->mapping);
+  CloseHandle(mf->file);
+#else
+  munmap((void*)mf->data, mf->size);
+#endif
+}
+
+
+/* PNG OUTPUT (indexed, uncompressed deflate)
+ * ---------------------------------------- */
+static uint32_t crcTable[256];
+
+/* Function:  initCrcTable
+ * ----------------------------------------
+ * build the png crc32 table
+ */
+static void initCrcTable(void)
+{
+  for (uint32_t n = 0; n < 256; ++n)
+  {
+    uint32_t c = n;
+    for (int k = 0; k < 8; ++k)
+    {
+      c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    }
+    crcTable[n] = c;
+  }
+}
+
+/* Function:  crc32Update
+ * ----------------------------------------
+ * update a png crc32
+ */
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len)
+{
+  for (size_t i = 0; i < len; ++i)
+  {
+    crc = crcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+/* Function:  writeBE32
+ * ----------------------------------------
+ * write a 32-bit big endian value
+ */
+static void writeBE32(uint8_t* dest, uint32_t value)
+{
+  dest[0] = (uint8_t)(value >> 24);
+  dest[1] = (uint8_t)(value >> 16);
+  dest[2] = (uint8_t)(value >> 8);
+  dest[3] = (uint8_t)value;
+}
+
+/* Function:  writePngChunk
+ * ----------------------------------------
+ * write a png chunk
+ */
+static void writePngChunk(FILE* f, const char* type, const uint8_t* data, uint32_t len)
+{
+  uint8_t buf[4];
+  writeBE32(buf, len);
+  fwrite(buf, 1, 4, f);
+  fwrite(type, 1, 4, f);
+  if (len) fwrite(data, 1, len, f);
+
+  uint32_t crc = crc32Update(0xffffffffu, (const uint8_t*)type, 4);
+  crc = crc32Update(crc, data, len) ^ 0xffffffffu;
+  writeBE32(buf, crc);
+  fwrite(buf, 1, 4, f);
+}
+
+/* Function:  writePng
+ * ----------------------------------------
+ * write an indexed png. the image fits in a single stored deflate block
+ */
+static void writePng(FILE* f, const uint8_t* frame, uint8_t idat[PNG_IDAT_BYTES])
+{
+  static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+  fwrite(signature, 1, sizeof(signature), f);
+
+  uint8_t ihdr[13];
+  writeBE32(ihdr, TMS9918_PIXELS_X);
+  writeBE32(ihdr + 4, TMS9918_PIXELS_Y);
+  ihdr[8] = 8;   /* bit depth */
+  ihdr[9] = 3;   /* indexed */
+  ihdr[10] = ihdr[11] = ihdr[12] = 0;
+  writePngChunk(f, "IHDR", ihdr, sizeof(ihdr));
+
+  uint8_t plte[PALETTE_SIZE * 3];
+  for (int i = 0; i < PALETTE_SIZE; ++i)
+  {
+    plte[i * 3 + 0] = (uint8_t)(vrEmuTms9918Palette[i] >> 24);
+    plte[i * 3 + 1] = (uint8_t)(vrEmuTms9918Palette[i] >> 16);
+    plte[i * 3 + 2] = (uint8_t)(vrEmuTms9918Palette[i] >> 8);
+  }
+  writePngChunk(f, "PLTE", plte, sizeof(plte));
+
+  uint8_t* p = idat;
+  *p++ = 0x78;   /* zlib header */
+  *p++ = 0x01;
+  *p++ = 0x01;   /* final, stored block */
+  *p++ = (uint8_t)(PNG_RAW_BYTES & 0xff);
+  *p++ = (uint8_t)(PNG_RAW_BYTES >> 8);
+  *p++ = (uint8_t)(~PNG_RAW_BYTES & 0xff);
+  *p++ = (uint8_t)((~PNG_RAW_BYTES >> 8) & 0xff);
+
+  uint32_t a = 1, b = 0;  /* adler32 */
+  for (int y = 0; y < TMS9918_PIXELS_Y; ++y)
+  {
+    *p++ = 0;    /* filter: none */
+    b = (b + a) % 65521;
+    memcpy(p, frame + y * TMS9918_PIXELS_X, TMS9918_PIXELS_X);
+    for (int x = 0; x < TMS9918_PIXELS_X; ++x)
+    {
+      a = (a + p[x]) % 65521;
+      b = (b + a) % 65521;
+    }
+    p += TMS9918_PIXELS_X;
+  }
+  writeBE32(p, (b << 16) | a);
+
+  writePngChunk(f, "IDAT", idat, PNG_IDAT_BYTES);
+  writePngChunk(f, "IEND", NULL, 0);
+}
+
+
+/* Function:  outputPath
+ * ----------------------------------------
+ * build the output filename for an input
+ */
+static void outputPath(char* dest, size_t destSize, const char* outDir, const char* input, OutputFormat format)
+{
+  static const char* const ext[] = { ".ppm", ".png", ".raw" };
+
+  const char* base = input;
+  for (const char* c = input; *c; ++c)
+  {
+    if (*c == '/' || *c == '\\') base = c + 1;
+  }
+
+  size_t baseLen = strlen(base);
+  const char* dot = strrchr(base, '.');
+  if (dot && dot != base) baseLen = (size_t)(dot - base);
+
+  if (outDir)
+    snprintf(dest, destSize, "%s/%.*s%s", outDir, (int)baseLen, base, ext[format]);
+  else
+    snprintf(dest, destSize, "%.*s%s", (int)(base - input + baseLen), input, ext[format]);
+}
+
+/* Function:  renderDump
+ * ----------------------------------------
+ * render a single dump to worker->frame
+ */
+static void renderDump(VrEmuTms9918* tms9918, const uint8_t* dump, uint8_t* frame)
+{
+  vrEmuTms9918Reset(tms9918);
+  vrEmuTms9918WriteVram(tms9918, 0, dump, DUMP_VRAM_BYTES);
+  for (int i = 0; i < TMS_NUM_REGISTERS; ++i)
+  {
+    vrEmuTms9918WriteRegValue(tms9918, (vrEmuTms9918Register)i, dump[DUMP_VRAM_BYTES + i]);
+  }
+
+  for (int y = 0; y < TMS9918_PIXELS_Y; ++y)
+  {
+    vrEmuTms9918ScanLine(tms9918, (uint8_t)y, frame + y * TMS9918_PIXELS_X);
+  }
+}
+
+/* Function:  writeFrame
+ * ----------------------------------------
+ * write a rendered frame in the requested format
+ */
+static bool writeFrame(Worker* worker, const char* filename)
+{
+  FILE* f = fopen(filename, "wb");
+  if (f == NULL)
+    return false;
+
+  switch (worker->job->format)
+  {
+    case FORMAT_PPM:
+      for (int i = 0; i < FRAME_PIXELS; ++i)
+      {
+        const uint32_t c = vrEmuTms9918Palette[worker->frame[i]];
+        worker->rgb[i * 3 + 0] = (uint8_t)(c >> 24);
+        worker->rgb[i * 3 + 1] = (uint8_t)(c >> 16);
+        worker->rgb[i * 3 + 2] = (uint8_t)(c >> 8);
+      }
+      fprintf(f, "P6\n%d %d\n255\n", TMS9918_PIXELS_X, TMS9918_PIXELS_Y);
+      fwrite(worker->rgb, 1, sizeof(worker->rgb), f);
+      break;
+
+    case FORMAT_PNG:
+      writePng(f, worker->frame, worker->idat);
+      break;
+
+    case FORMAT_RAW:
+      fwrite(worker->frame, 1, sizeof(worker->frame), f);
+      break;
+  }
+
+  return fclose(f) == 0;
+}
+
+/* Function:  workerMain
+ * ----------------------------------------
+ * render inputs until none remain
+ */
+static void workerMain(Worker* worker)
+{
+  Job* job = worker->job;
+  VrEmuTms9918* tms9918 = vrEmuTms9918New();
+  char filename[4096];
+
+  if (tms9918 == NULL)
+  {
+    /* leave the inputs to the other workers */
+    fprintf(stderr, "unable to create a TMS9918 instance\n");
+    return;
+  }
+
+  for (long i = claimInput(job); i < job->numInputs; i = claimInput(job))
+  {
+    MappedFile mf;
+    if (!mapFile(job->inputs[i], &mf))
+    {
+      fprintf(stderr, "unable to read: %s\n", job->inputs[i]);
+      ++worker->failed;
+      continue;
+    }
+
+    if (mf.size < DUMP_BYTES)
+    {
+      fprintf(stderr, "too small (%d bytes expected): %s\n", DUMP_BYTES, job->inputs[i]);
+      unmapFile(&mf);
+      ++worker->failed;
+      continue;
+    }
+
+    const double start = nowSeconds();
+    renderDump(tms9918, mf.data, worker->frame);
+    worker->renderSeconds += nowSeconds() - start;
+    unmapFile(&mf);
+
+    outputPath(filename, sizeof(filename), job->outDir, job->inputs[i], job->format);
+    if (writeFrame(worker, filename))
+    {
+      ++worker->rendered;
+    }
+    else
+    {
+      fprintf(stderr, "unable to write: %s\n", filename);
+      ++worker->failed;
+    }
+  }
+
+  vrEmuTms9918Destroy(tms9918);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI threadMain(LPVOID param)
+{
+  workerMain((Worker*)param);
+  return 0;
+}
+#else
+static void* threadMain(void* param)
+{
+  workerMain((Worker*)param);
+  return NULL;
+}
+#endif
+
+static void usage(const char* name)
+{
+  fprintf(stderr, "usage: %s [-f ppm|png|raw] [-o outdir] [-j threads] dump...\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+  Job job;
+  job.format = FORMAT_PNG;
+  job.outDir = NULL;
+  job.nextInput = 0;
+
+  int numThreads = numCores();
+
+  int argi = 1;
+  for (; argi < argc && argv[argi][0] == '-'; ++argi)
+  {
+    if (argi + 1 >= argc)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+
+    const char* value = argv[argi + 1];
+    if (strcmp(argv[argi], "-f") == 0)
+    {
+      if (strcmp(value, "ppm") == 0) job.format = FORMAT_PPM;
+      else if (strcmp(value, "png") == 0) job.format = FORMAT_PNG;
+      else if (strcmp(value, "raw") == 0) job.format = FORMAT_RAW;
+      else { usage(argv[0]); return 1; }
+    }
+    else if (strcmp(argv[argi], "-o") == 0)
+    {
+      job.outDir = value;
+    }
+    else if (strcmp(argv[argi], "-j") == 0)
+    {
+      numThreads = atoi(value);
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    ++argi;
+  }
+
+  if (argi >= argc || numThreads < 1)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  job.inputs = argv + argi;
+  job.numInputs = argc - argi;
+
+  if (numThreads > job.numInputs) numThreads = job.numInputs;
+  if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+
+  initCrcTable();
+
+  Worker* workers = (Worker*)calloc((size_t)numThreads, sizeof(Worker));
+  if (workers == NULL)
+    return 1;
+
+  const double start = nowSeconds();
+
+#ifdef _WIN32
+  HANDLE threads[MAX_THREADS];
+#else
+  pthread_t threads[MAX_THREADS];
+#endif
+
+  int started = 0;
+  for (; started < numThreads; ++started)
+  {
+    workers[started].job = &job;
+#ifdef _WIN32
+    threads[started] = CreateThread(NULL, 0, threadMain, &workers[started], 0, NULL);
+    if (threads[started] == NULL)
+      break;
+#else
+    if (pthread_create(&threads[started], NULL, threadMain, &workers[started]) != 0)
+      break;
+#endif
+  }
+
+  if (started < numThreads)
+  {
+    fprintf(stderr, "unable to start more than %d of %d threads\n", started, numThreads);
+    numThreads = started;
+  }
+
+  if (started == 0)
+  {
+    /* no threads at all. render on this one */
+    workerMain(&workers[0]);
+    numThreads = 1;
+  }
+
+  int rendered = 0, failed = 0;
+  double renderSeconds = 0.0;
+
+  for (int i = 0; i < numThreads; ++i)
+  {
+    if (i < started)
+    {
+#ifdef _WIN32
+      WaitForSingleObject(threads[i], INFINITE);
+      CloseHandle(threads[i]);
+#else
+      pthread_join(threads[i], NULL);
+#endif
+    }
+    rendered += workers[i].rendered;
+    failed += workers[i].failed;
+    renderSeconds += workers[i].renderSeconds;
+  }
+
+  /* inputs no worker could take (no instance) */
+  if (rendered + failed < job.numInputs)
+  {
+    fprintf(stderr, "%d dumps not rendered\n", job.numInputs - rendered - failed);
+    failed = job.numInputs - rendered;
+  }
+
+  const double elapsed = nowSeconds() - start;
+
+  printf("dumps:        %d rendered, %d failed\n", rendered, failed);
+  printf("threads:      %d\n", numThreads);
+  printf("wall time:    %.3f s\n", elapsed);
+  if (rendered)
+  {
+    printf("dumps/s:      %.1f\n", rendered / elapsed);
+    printf("render time:  %.1f us/dump (excluding i/o)\n", renderSeconds / rendered * 1e6);
+  }
+
+  free(workers);
+
+  return failed ? 2 : 0;
+}
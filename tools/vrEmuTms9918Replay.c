@@ -0,0 +1,148 @@
+/*
+ * Troy's TMS9918 Emulator - Trace replay benchmark
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ * Replays a port I/O trace (see vrEmuTms9918Trace.h) as fast as
+ * possible and reports throughput.
+ *
+ * With a profile prefix, VRAM access counters for one replay are written
+ * to <prefix>.csv and <prefix>-writes.pgm, -reads.pgm and -fetches.pgm
+ * heatmaps (requires a VR_EMU_TMS9918_PROFILE build).
+ *
+ * usage: vrEmuTms9918Replay <trace file> [iterations] [profile prefix]
+ */
+
+#include "vrEmuTms9918Trace.h"
+#include "vrEmuTms9918Profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_PATH_BYTES  1024
+
+/* Function:  writeProfile
+ * ----------------------------------------
+ * write profile csv and heatmaps
+ */
+static bool writeProfile(const vrEmuTms9918Profile* profile, const char* prefix)
+{
+  char path[MAX_PATH_BYTES];
+  uint32_t fetches[TMS_PROFILE_BLOCKS];
+  vrEmuTms9918ProfileTotalFetches(profile, fetches);
+
+  bool ok = true;
+  snprintf(path, sizeof(path), "%s.csv", prefix);
+  ok &= vrEmuTms9918ProfileWriteCsv(profile, path);
+  snprintf(path, sizeof(path), "%s-writes.pgm", prefix);
+  ok &= vrEmuTms9918ProfileWriteHeatmap(profile->portWrites, path);
+  snprintf(path, sizeof(path), "%s-reads.pgm", prefix);
+  ok &= vrEmuTms9918ProfileWriteHeatmap(profile->portReads, path);
+  snprintf(path, sizeof(path), "%s-fetches.pgm", prefix);
+  ok &= vrEmuTms9918ProfileWriteHeatmap(fetches, path);
+  return ok;
+}
+
+/* Function:  nowSeconds
+ * ----------------------------------------
+ * wall clock time in seconds
+ */
+static double nowSeconds(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: %s <trace file> [iterations] [profile prefix]\n", argv[0]);
+    return 1;
+  }
+
+  const int iterations = (argc > 2) ? atoi(argv[2]) : 10;
+  if (iterations < 1)
+  {
+    fprintf(stderr, "invalid iteration count: %s\n", argv[2]);
+    return 1;
+  }
+
+  VrEmuTms9918TracePlayer* player = vrEmuTms9918TracePlayerNew(argv[1]);
+  if (player == NULL)
+  {
+    fprintf(stderr, "unable to load trace: %s\n", argv[1]);
+    return 1;
+  }
+
+  VrEmuTms9918* tms9918 = vrEmuTms9918NewWithVram(vrEmuTms9918TracePlayerVramSize(player));
+  if (tms9918 == NULL)
+  {
+    fprintf(stderr, "unable to create tms9918\n");
+    vrEmuTms9918TracePlayerDestroy(player);
+    return 1;
+  }
+  vrEmuTms9918TraceStats stats;
+
+  /* profile the warm up pass only */
+  static vrEmuTms9918Profile profile;
+  const char* profilePrefix = (argc > 3) ? argv[3] : NULL;
+  if (profilePrefix && !vrEmuTms9918SetProfile(tms9918, &profile))
+  {
+    fprintf(stderr, "warning: profiling not available (build with VR_EMU_TMS9918_PROFILE)\n");
+    profilePrefix = NULL;
+  }
+
+  /* warm up (and validate) */
+  if (!vrEmuTms9918TracePlay(player, tms9918, NULL, NULL, &stats))
+  {
+    fprintf(stderr, "warning: trace is truncated or corrupt. replaying valid portion\n");
+  }
+
+  if (profilePrefix)
+  {
+    vrEmuTms9918SetProfile(tms9918, NULL);
+    if (!writeProfile(&profile, profilePrefix))
+    {
+      fprintf(stderr, "unable to write profile: %s\n", profilePrefix);
+    }
+  }
+
+  const double start = nowSeconds();
+  for (int i = 0; i < iterations; ++i)
+  {
+    vrEmuTms9918TracePlay(player, tms9918, NULL, NULL, NULL);
+  }
+  const double elapsed = (nowSeconds() - start) / iterations;
+
+  const uint64_t ops = stats.writeAddr + stats.writeData + stats.readData + stats.readStatus;
+
+  printf("trace:        %s\n", argv[1]);
+  printf("iterations:   %d\n", iterations);
+  printf("write addr:   %llu\n", (unsigned long long)stats.writeAddr);
+  printf("write data:   %llu\n", (unsigned long long)stats.writeData);
+  printf("read data:    %llu\n", (unsigned long long)stats.readData);
+  printf("read status:  %llu\n", (unsigned long long)stats.readStatus);
+  printf("scanlines:    %llu (%.1f frames)\n", (unsigned long long)stats.scanLines, (double)stats.scanLines / TMS9918_PIXELS_Y);
+  printf("recorded time: %llu\n", (unsigned long long)stats.duration);
+  printf("replay time:  %.3f ms\n", elapsed * 1e3);
+
+  if (elapsed > 0.0)
+  {
+    printf("port ops/s:   %.2f M\n", ops / elapsed * 1e-6);
+    printf("vram MB/s:    %.2f\n", (stats.writeData + stats.readData) / elapsed * 1e-6);
+    printf("scanlines/s:  %.2f M\n", stats.scanLines / elapsed * 1e-6);
+    printf("frames/s:     %.1f\n", (double)stats.scanLines / TMS9918_PIXELS_Y / elapsed);
+  }
+
+  vrEmuTms9918Destroy(tms9918);
+  vrEmuTms9918TracePlayerDestroy(player);
+
+  return 0;
+}
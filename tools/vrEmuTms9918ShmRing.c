@@ -0,0 +1,219 @@
+/*
+ * Troy's TMS9918 Emulator - Shared memory frame ring writer / reader
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ * Exercises a shared memory frame ring (see vrEmuTms9918ShmRing.h)
+ * across processes. Run a writer and a reader with the same name.
+ *
+ * usage: vrEmuTms9918ShmRing write <name> [frames] [fps]
+ *        vrEmuTms9918ShmRing read <name> [frames] [last frame .ppm]
+ */
+
+/* nanosleep under strict -std=c11 */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "vrEmuTms9918ShmRing.h"
+#include "vrEmuTms9918Util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RING_FRAMES         4
+#define FRAME_PIXELS        (TMS9918_PIXELS_X * TMS9918_PIXELS_Y)
+#define OPEN_TIMEOUT_MS     5000
+#define IDLE_TIMEOUT_MS     2000
+
+/* Function:  sleepMs
+ * ----------------------------------------
+ * sleep for a number of milliseconds
+ */
+static void sleepMs(long ms)
+{
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000L;
+  nanosleep(&ts, NULL);
+}
+
+/* Function:  countBits
+ * ----------------------------------------
+ * number of set bits in a dirty line bitmap
+ */
+static int countBits(const uint32_t* words, int numWords)
+{
+  int count = 0;
+  for (int i = 0; i < numWords; ++i)
+  {
+    for (uint32_t w = words[i]; w; w &= w - 1)
+    {
+      ++count;
+    }
+  }
+  return count;
+}
+
+/* Function:  writePpm
+ * ----------------------------------------
+ * write a frame as a binary ppm
+ */
+static bool writePpm(const char* filename, const uint8_t* pixels)
+{
+  FILE* file = fopen(filename, "wb");
+  if (file == NULL)
+    return false;
+
+  fprintf(file, "P6\n%d %d\n255\n", TMS9918_PIXELS_X, TMS9918_PIXELS_Y);
+  for (int i = 0; i < FRAME_PIXELS; ++i)
+  {
+    const uint32_t rgba = vrEmuTms9918Palette[pixels[i] & 0x0f];
+    const uint8_t rgb[3] = { (uint8_t)(rgba >> 24), (uint8_t)(rgba >> 16), (uint8_t)(rgba >> 8) };
+    fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  return fclose(file) == 0;
+}
+
+/* Function:  runWriter
+ * ----------------------------------------
+ * render an animated test screen into the ring
+ */
+static int runWriter(const char* name, long frames, long fps)
+{
+  VrEmuTms9918ShmRing* ring = vrEmuTms9918ShmRingCreate(name, RING_FRAMES);
+  if (ring == NULL)
+  {
+    fprintf(stderr, "unable to create shared memory ring: %s\n", name);
+    return 1;
+  }
+
+  VrEmuTms9918* tms9918 = vrEmuTms9918New();
+  vrEmuTms9918InitialiseGfxII(tms9918);
+
+  /* a pattern per screen third and a single moving 8x8 sprite */
+  vrEmuTms9918SetAddressWrite(tms9918, TMS_DEFAULT_VRAM_PATT_ADDRESS);
+  for (int i = 0; i < 0x1800; ++i)
+  {
+    vrEmuTms9918WriteData(tms9918, (uint8_t)((i & 7) < 4 ? 0xf0 : 0x0f));
+  }
+  vrEmuTms9918SetAddressWrite(tms9918, TMS_DEFAULT_VRAM_COLOR_ADDRESS);
+  for (int i = 0; i < 0x1800; ++i)
+  {
+    vrEmuTms9918WriteData(tms9918, (uint8_t)(((i >> 3) & 0xf0) | ((i >> 11) + TMS_DK_BLUE)));
+  }
+  vrEmuTms9918SetAddressWrite(tms9918, TMS_DEFAULT_VRAM_SPRITE_PATT_ADDRESS);
+  vrEmuTms9918WriteByteRpt(tms9918, 0xff, 8);
+
+  for (long frame = 0; frame < frames; ++frame)
+  {
+    const uint8_t attr[5] = { (uint8_t)(frame % 192), (uint8_t)(frame * 3), 0, TMS_WHITE, 0xd0 };
+    vrEmuTms9918SetAddressWrite(tms9918, TMS_DEFAULT_VRAM_SPRITE_ATTR_ADDRESS);
+    vrEmuTms9918WriteBytes(tms9918, attr, sizeof(attr));
+
+    vrEmuTms9918ShmRingRenderFrame(ring, tms9918);
+    vrEmuTms9918ReadStatus(tms9918);
+
+    if (fps > 0)
+    {
+      sleepMs(1000 / fps);
+    }
+  }
+
+  /* give readers a moment to see the last frame before the name goes */
+  sleepMs(IDLE_TIMEOUT_MS / 2);
+
+  vrEmuTms9918Destroy(tms9918);
+  vrEmuTms9918ShmRingDestroy(ring);
+  return 0;
+}
+
+/* Function:  runReader
+ * ----------------------------------------
+ * consume frames from the ring, reporting each one
+ */
+static int runReader(const char* name, long frames, const char* ppmFile)
+{
+  VrEmuTms9918ShmRing* ring = NULL;
+  for (int waited = 0; ring == NULL && waited < OPEN_TIMEOUT_MS; waited += 10)
+  {
+    ring = vrEmuTms9918ShmRingOpen(name);
+    if (ring == NULL) sleepMs(10);
+  }
+  if (ring == NULL)
+  {
+    fprintf(stderr, "unable to open shared memory ring: %s\n", name);
+    return 1;
+  }
+
+  static uint8_t lastFrame[FRAME_PIXELS];
+  uint64_t lastSequence = 0;
+  long received = 0, skipped = 0, torn = 0;
+  int idleMs = 0;
+
+  while (received < frames && idleMs < IDLE_TIMEOUT_MS)
+  {
+    vrEmuTms9918ShmFrame frame;
+    if (!vrEmuTms9918ShmRingLatest(ring, lastSequence, &frame))
+    {
+      sleepMs(1);
+      ++idleMs;
+      continue;
+    }
+    idleMs = 0;
+
+    /* consume in place, then make sure the writer didn't catch up */
+    memcpy(lastFrame, frame.pixels, FRAME_PIXELS);
+    if (!vrEmuTms9918ShmRingValidate(ring, &frame))
+    {
+      ++torn;
+      continue;
+    }
+
+    if (lastSequence && frame.sequence != lastSequence + 1)
+    {
+      skipped += (long)(frame.sequence - lastSequence - 1);
+    }
+
+    printf("frame %llu  status %02x  dirty lines %d\n", (unsigned long long)frame.sequence,
+           frame.status, countBits(frame.dirtyLines, TMS_SHM_RING_DIRTY_WORDS));
+
+    lastSequence = frame.sequence;
+    ++received;
+  }
+
+  printf("received %ld frames (%ld skipped, %ld torn reads discarded)\n", received, skipped, torn);
+
+  if (ppmFile && received && !writePpm(ppmFile, lastFrame))
+  {
+    fprintf(stderr, "unable to write %s\n", ppmFile);
+  }
+
+  vrEmuTms9918ShmRingDestroy(ring);
+  return received ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3 || (strcmp(argv[1], "write") != 0 && strcmp(argv[1], "read") != 0))
+  {
+    fprintf(stderr, "usage: %s write <name> [frames] [fps]\n", argv[0]);
+    fprintf(stderr, "       %s read <name> [frames] [last frame .ppm]\n", argv[0]);
+    return 1;
+  }
+
+  const long frames = (argc > 3) ? atol(argv[3]) : 600;
+
+  if (strcmp(argv[1], "write") == 0)
+  {
+    return runWriter(argv[2], frames, (argc > 4) ? atol(argv[4]) : 60);
+  }
+
+  return runReader(argv[2], frames, (argc > 4) ? argv[4] : NULL);
+}
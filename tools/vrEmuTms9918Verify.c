@@ -0,0 +1,792 @@
+/*
+ * Troy's TMS9918 Emulator - Golden frame verification
+ *
+ * Copyright (c) 2026 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/vrEmuTms9918
+ *
+ * Renders randomized and recorded states with the frozen reference
+ * renderer (vrEmuTms9918Reference.c) and with each render path of the
+ * library, compares pixels, the status register after every line and
+ * the INT output byte for byte, and reports the speedup of each path
+ * over the reference. the tile atlas and tile map are also composited
+ * and compared against the background (sprites excluded), and the
+ * reference frames are round tripped through the delta encoder (key
+ * frames, unchanged frames and partial spans).
+ *
+ * Recorded states are the end of each frame of a port I/O trace (see
+ * vrEmuTms9918Trace.h). Only 16KB traces are supported.
+ *
+ * exits with 1 if any path differs from the reference.
+ *
+ * usage: vrEmuTms9918Verify [random states per case] [iterations] [trace file ...]
+ */
+
+#include "vrEmuTms9918Reference.h"
+#include "vrEmuTms9918Atlas.h"
+#include "vrEmuTms9918Delta.h"
+#include "vrEmuTms9918Layers.h"
+#include "vrEmuTms9918Trace.h"
+#include "vrEmuTms9918Util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FRAME_PIXELS    (TMS9918_PIXELS_X * TMS9918_PIXELS_Y)
+#define MAX_STATES      TMS_MULTI_MAX_LANES
+#define MAX_MISMATCHES  5   /* reported per path */
+
+typedef enum
+{
+  PATH_SCANLINE,
+  PATH_SCANLINE_MULTI,
+  PATH_RUN_FRAME,
+  PATH_SCAN_ROW,
+  PATH_LAYERS,
+  NUM_PATHS
+} VerifyPath;
+
+static const char* const pathNames[NUM_PATHS] = { "ScanLine", "ScanLineMulti", "RunFrame", "ScanRow", "Layers" };
+
+/* a state to render */
+typedef struct
+{
+  uint8_t registers[TMS_NUM_REGISTERS];
+  uint8_t vram[TMS_VRAM_16K];
+} VerifyState;
+
+/* rendered output of a state */
+typedef struct
+{
+  uint8_t pixels[FRAME_PIXELS];
+  uint8_t status[TMS9918_PIXELS_Y];   /* after each observable line (see statusObservable) */
+  bool intActive;
+} VerifyFrame;
+
+/* results of a case, accumulated over batches of states */
+typedef struct
+{
+  long frames;
+  double refSeconds;
+  double seconds[NUM_PATHS];
+  long mismatches[NUM_PATHS];
+  long atlasMismatches;
+  long deltaMismatches;
+} VerifyResult;
+
+static VerifyState states[MAX_STATES];
+static vrEmuTms9918Reference references[MAX_STATES];
+static VerifyFrame expected[MAX_STATES];
+static VerifyFrame actual[MAX_STATES];
+static VrEmuTms9918* instances[MAX_STATES];
+static VrEmuTms9918Layers* layers;
+static VrEmuTms9918Atlas* atlas;
+
+static int iterations = 10;
+
+
+/* Function:  nowSeconds
+ * ----------------------------------------
+ * wall clock time in seconds
+ */
+static double nowSeconds(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Function:  randomByte
+ * ----------------------------------------
+ * deterministic pseudo random byte (xorshift32)
+ */
+static uint8_t randomByte(void)
+{
+  static uint32_t seed = 0x9918a5a5;
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return (uint8_t)(seed >> 11);
+}
+
+/* Function:  loadInstance
+ * ----------------------------------------
+ * load a state into a library instance (status and latches cleared)
+ */
+static void loadInstance(VrEmuTms9918* tms9918, const VerifyState* state)
+{
+  for (int reg = 0; reg < TMS_NUM_REGISTERS; ++reg)
+  {
+    vrEmuTms9918WriteRegValue(tms9918, (vrEmuTms9918Register)reg, state->registers[reg]);
+  }
+  vrEmuTms9918WriteVram(tms9918, 0, state->vram, TMS_VRAM_16K);
+
+  vrEmuTms9918PortState portState;
+  memset(&portState, 0, sizeof(portState));
+  vrEmuTms9918SetPortState(tms9918, &portState);
+}
+
+/* Function:  instanceStatus
+ * ----------------------------------------
+ * status register without the side effects of reading it
+ */
+static uint8_t instanceStatus(VrEmuTms9918* tms9918)
+{
+  vrEmuTms9918PortState portState;
+  vrEmuTms9918GetPortState(tms9918, &portState);
+  return portState.status;
+}
+
+/* Function:  statusObservable
+ * ----------------------------------------
+ * can the status after line y be captured for path?
+ */
+static bool statusObservable(VerifyPath path, int y)
+{
+  switch (path)
+  {
+    case PATH_SCAN_ROW:
+      return (y % TMS9918_ROW_LINES) == TMS9918_ROW_LINES - 1;
+
+    case PATH_LAYERS:
+      return y == TMS9918_PIXELS_Y - 1;
+
+    default:
+      return true;
+  }
+}
+
+/* Function:  runFrameBlock
+ * ----------------------------------------
+ * RunFrame callback (one line per block). record the status
+ */
+static void runFrameBlock(void* userData, const vrEmuTms9918LineBlock* block)
+{
+  const int i = (int)(intptr_t)userData;
+  actual[i].status[block->firstLine] = instanceStatus(instances[i]);
+}
+
+/* Function:  renderReference
+ * ----------------------------------------
+ * render a pass of numStates states with the reference
+ */
+static void renderReference(int numStates, bool capture)
+{
+  for (int i = 0; i < numStates; ++i)
+  {
+    for (int y = 0; y < TMS9918_PIXELS_Y; ++y)
+    {
+      vrEmuTms9918ReferenceScanLine(&references[i], (uint8_t)y, expected[i].pixels + y * TMS9918_PIXELS_X);
+      if (capture) expected[i].status[y] = references[i].status;
+    }
+    if (capture) expected[i].intActive = references[i].intActive;
+  }
+}
+
+/* Function:  renderPath
+ * ----------------------------------------
+ * render a pass of numStates states with a library path
+ */
+static void renderPath(VerifyPath path, int numStates, bool capture)
+{
+  uint8_t* linePixels[MAX_STATES];
+
+  switch (path)
+  {
+    case PATH_SCANLINE:
+      for (int i = 0; i < numStates; ++i)
+      {
+        for (int y = 0; y < TMS9918_PIXELS_Y; ++y)
+        {
+          vrEmuTms9918ScanLine(instances[i], (uint8_t)y, actual[i].pixels + y * TMS9918_PIXELS_X);
+          if (capture) actual[i].status[y] = instanceStatus(instances[i]);
+        }
+      }
+      break;
+
+    case PATH_SCANLINE_MULTI:
+      for (int y = 0; y < TMS9918_PIXELS_Y; ++y)
+      {
+        for (int i = 0; i < numStates; ++i)
+        {
+          linePixels[i] = actual[i].pixels + y * TMS9918_PIXELS_X;
+        }
+        vrEmuTms9918ScanLineMulti(instances, (unsigned int)numStates, (uint8_t)y, linePixels);
+        for (int i = 0; capture && i < numStates; ++i)
+        {
+          actual[i].status[y] = instanceStatus(instances[i]);
+        }
+      }
+      break;
+
+    case PATH_RUN_FRAME:
+      for (int i = 0; i < numStates; ++i)
+      {
+        if (capture)
+        {
+          vrEmuTms9918RunFrame(instances[i], actual[i].pixels, 1, runFrameBlock, (void*)(intptr_t)i);
+        }
+        else
+        {
+          vrEmuTms9918RunFrame(instances[i], actual[i].pixels, TMS9918_PIXELS_Y, NULL, NULL);
+        }
+      }
+      break;
+
+    case PATH_SCAN_ROW:
+      for (int i = 0; i < numStates; ++i)
+      {
+        for (int row = 0; row < TMS9918_ROWS; ++row)
+        {
+          vrEmuTms9918ScanRow(instances[i], (uint8_t)row, actual[i].pixels + row * TMS9918_ROW_LINES * TMS9918_PIXELS_X);
+          if (capture) actual[i].status[(row + 1) * TMS9918_ROW_LINES - 1] = instanceStatus(instances[i]);
+        }
+      }
+      break;
+
+    case PATH_LAYERS:
+      for (int i = 0; i < numStates; ++i)
+      {
+        vrEmuTms9918LayersRender(layers, instances[i], actual[i].pixels);
+        if (capture) actual[i].status[TMS9918_PIXELS_Y - 1] = instanceStatus(instances[i]);
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  for (int i = 0; capture && i < numStates; ++i)
+  {
+    actual[i].intActive = vrEmuTms9918InterruptActive(instances[i]);
+  }
+}
+
+/* Function:  compareFrames
+ * ----------------------------------------
+ * compare actual against expected. returns the number of mismatched
+ * states, reporting the first few differences
+ */
+static long compareFrames(const char* caseName, VerifyPath path, int numStates, long firstFrame)
+{
+  long mismatches = 0;
+
+  for (int i = 0; i < numStates; ++i)
+  {
+    const char* what = NULL;
+    int where = 0;
+
+    for (int p = 0; p < FRAME_PIXELS && !what; ++p)
+    {
+      if (actual[i].pixels[p] != expected[i].pixels[p])
+      {
+        what = "pixel";
+        where = p;
+      }
+    }
+
+    for (int y = 0; y < TMS9918_PIXELS_Y && !what; ++y)
+    {
+      if (!statusObservable(path, y))
+        continue;
+
+      if (actual[i].status[y] != expected[i].status[y])
+      {
+        what = "status";
+        where = y;
+      }
+    }
+
+    if (!what && actual[i].intActive != expected[i].intActive)
+    {
+      what = "INT";
+    }
+
+    if (what)
+    {
+      if (++mismatches <= MAX_MISMATCHES)
+      {
+        fprintf(stderr, "MISMATCH %s %s frame %ld: ", caseName, pathNames[path], firstFrame + i);
+        if (what[0] == 'p')
+        {
+          fprintf(stderr, "pixel (%d, %d) is %d, expected %d\n", where % TMS9918_PIXELS_X, where / TMS9918_PIXELS_X,
+                  actual[i].pixels[where], expected[i].pixels[where]);
+        }
+        else if (what[0] == 's')
+        {
+          fprintf(stderr, "status after line %d is %02x, expected %02x\n", where,
+                  actual[i].status[where], expected[i].status[where]);
+        }
+        else
+        {
+          fprintf(stderr, "INT is %d, expected %d\n", actual[i].intActive, expected[i].intActive);
+        }
+      }
+    }
+  }
+  return mismatches;
+}
+
+/* Function:  verifyAtlas
+ * ----------------------------------------
+ * composite the tile atlas through the tile map and compare it against
+ * the background of numStates states. returns the number of mismatched
+ * states, reporting the first few differences
+ */
+static long verifyAtlas(const char* caseName, int numStates, long firstFrame)
+{
+  static uint16_t map[TMS_ATLAS_MAP_ROWS * TMS_ATLAS_MAP_MAX_COLS];
+  uint8_t line[TMS9918_PIXELS_X];
+  long mismatches = 0;
+
+  for (int i = 0; i < numStates; ++i)
+  {
+    VrEmuTms9918* tms9918 = instances[i];
+    loadInstance(tms9918, &states[i]);
+    if (!vrEmuTms9918DisplayEnabled(tms9918))
+      continue;
+
+    vrEmuTms9918AtlasUpdate(atlas, tms9918);
+    const uint8_t cols = vrEmuTms9918AtlasTileMap(tms9918, map);
+    const uint8_t* tiles = (const uint8_t*)vrEmuTms9918AtlasPixels(atlas);
+    const bool text = cols == TMS_ATLAS_MAP_MAX_COLS;
+    const int tileWidth = text ? 6 : 8;
+    const int border = text ? 8 : 0;
+
+    bool match = true;
+    for (int y = 0; y < TMS9918_PIXELS_Y && match; ++y)
+    {
+      vrEmuTms9918BackgroundScanLine(tms9918, (uint8_t)y, line);
+      for (int x = 0; x < TMS9918_PIXELS_X && match; ++x)
+      {
+        uint8_t color = vrEmuTms9918RegValue(tms9918, TMS_REG_FG_BG_COLOR) & 0x0f;
+        if (x >= border && x < TMS9918_PIXELS_X - border)
+        {
+          const uint16_t tile = map[(y / 8) * cols + (x - border) / tileWidth];
+          color = tiles[((tile / TMS_ATLAS_TILES_PER_ROW) * 8 + (y & 7)) * TMS_ATLAS_WIDTH +
+                        (tile % TMS_ATLAS_TILES_PER_ROW) * 8 + (x - border) % tileWidth];
+        }
+
+        if (color != line[x])
+        {
+          match = false;
+          if (++mismatches <= MAX_MISMATCHES)
+          {
+            fprintf(stderr, "MISMATCH %s Atlas frame %ld: pixel (%d, %d) is %d, expected %d\n",
+                    caseName, firstFrame + i, x, y, color, line[x]);
+          }
+        }
+      }
+    }
+  }
+  return mismatches;
+}
+
+/* Function:  deltaRoundTrip
+ * ----------------------------------------
+ * encode frame relative to prevFrame (a key frame if NULL), decode it
+ * over decoded and check decoded now matches frame. expectBytes is the
+ * exact encoded size expected, or 0 for any
+ */
+static bool deltaRoundTrip(const uint8_t* prevFrame, const uint8_t* frame, uint8_t* decoded, size_t expectBytes)
+{
+  static uint8_t encoded[TMS_DELTA_MAX_FRAME_BYTES];
+
+  const size_t bytes = vrEmuTms9918DeltaEncode(prevFrame, frame, encoded, sizeof(encoded));
+  if (bytes == 0 || (expectBytes && bytes != expectBytes) ||
+      vrEmuTms9918DeltaIsKeyFrame(encoded, bytes) != (prevFrame == NULL))
+    return false;
+
+  return vrEmuTms9918DeltaDecode(encoded, bytes, decoded) == bytes &&
+         memcmp(decoded, frame, FRAME_PIXELS) == 0;
+}
+
+/* Function:  verifyDelta
+ * ----------------------------------------
+ * round trip the reference frames of numStates states through the delta
+ * encoder as a stream: a key frame, then for each state a delta from the
+ * previous one, an unchanged frame and a few partial spans. returns the
+ * number of states that failed
+ */
+static long verifyDelta(const char* caseName, int numStates, long firstFrame)
+{
+  static uint8_t decoded[FRAME_PIXELS];
+  static uint8_t edited[FRAME_PIXELS];
+  long mismatches = 0;
+
+  memset(decoded, 0xff, sizeof(decoded));
+
+  for (int i = 0; i < numStates; ++i)
+  {
+    const uint8_t* frame = expected[i].pixels;
+
+    /* short runs on some lines, far enough apart to be separate spans */
+    memcpy(edited, frame, FRAME_PIXELS);
+    for (int y = i % 7; y < TMS9918_PIXELS_Y; y += 7)
+    {
+      const int x = (y * 13 + i) % (TMS9918_PIXELS_X - TMS_DELTA_MIN_GAP * 2 - 8);
+      for (int j = 0; j < 5; ++j)
+      {
+        edited[y * TMS9918_PIXELS_X + x + j] ^= 0x01;
+        edited[y * TMS9918_PIXELS_X + x + TMS_DELTA_MIN_GAP * 2 + j] ^= 0x0f;
+      }
+    }
+
+    const bool ok = deltaRoundTrip(i ? expected[i - 1].pixels : NULL, frame, decoded, 0) &&
+                    deltaRoundTrip(frame, frame, decoded, TMS_DELTA_HEADER_BYTES) &&
+                    deltaRoundTrip(frame, edited, decoded, 0) &&
+                    deltaRoundTrip(edited, frame, decoded, 0);
+    if (!ok)
+    {
+      if (++mismatches <= MAX_MISMATCHES)
+      {
+        fprintf(stderr, "MISMATCH %s Delta frame %ld: round trip differs\n", caseName, firstFrame + i);
+      }
+      memcpy(decoded, frame, FRAME_PIXELS);
+    }
+  }
+  return mismatches;
+}
+
+/* Function:  verifyBatch
+ * ----------------------------------------
+ * verify and time numStates states against every path. the first pass
+ * from the loaded state is compared, further passes are timed
+ */
+static void verifyBatch(const char* caseName, int numStates, VerifyResult* result)
+{
+  for (int i = 0; i < numStates; ++i)
+  {
+    vrEmuTms9918ReferenceLoad(&references[i], states[i].registers, 0, states[i].vram);
+  }
+  renderReference(numStates, true);
+
+  double start = nowSeconds();
+  for (int it = 0; it < iterations; ++it)
+  {
+    renderReference(numStates, false);
+  }
+  result->refSeconds += (nowSeconds() - start) / iterations;
+
+  for (int path = 0; path < NUM_PATHS; ++path)
+  {
+    for (int i = 0; i < numStates; ++i)
+    {
+      loadInstance(instances[i], &states[i]);
+      memset(&actual[i], 0, sizeof(actual[i]));
+    }
+    renderPath((VerifyPath)path, numStates, true);
+    result->mismatches[path] += compareFrames(caseName, (VerifyPath)path, numStates, result->frames);
+
+    start = nowSeconds();
+    for (int it = 0; it < iterations; ++it)
+    {
+      renderPath((VerifyPath)path, numStates, false);
+    }
+    result->seconds[path] += (nowSeconds() - start) / iterations;
+  }
+
+  result->atlasMismatches += verifyAtlas(caseName, numStates, result->frames);
+  result->deltaMismatches += verifyDelta(caseName, numStates, result->frames);
+  result->frames += numStates;
+}
+
+/* Function:  printResult
+ * ----------------------------------------
+ * print a row of the results table
+ */
+static void printResult(const char* caseName, const VerifyResult* result)
+{
+  if (result->frames == 0)
+    return;
+
+  printf("%-24s %6ld %10.1f", caseName, result->frames, result->refSeconds / result->frames * 1e6);
+  for (int path = 0; path < NUM_PATHS; ++path)
+  {
+    const double speedup = result->seconds[path] > 0.0 ? result->refSeconds / result->seconds[path] : 0.0;
+    if (result->mismatches[path])
+    {
+      printf("   %6.2fx FAIL(%ld)", speedup, result->mismatches[path]);
+    }
+    else
+    {
+      printf("   %6.2fx ok      ", speedup);
+    }
+  }
+  if (result->atlasMismatches)
+  {
+    printf("   FAIL(%-3ld)", result->atlasMismatches);
+  }
+  else
+  {
+    printf("   ok       ");
+  }
+  if (result->deltaMismatches)
+  {
+    printf("   FAIL(%ld)", result->deltaMismatches);
+  }
+  else
+  {
+    printf("   ok");
+  }
+  printf("\n");
+}
+
+/* Function:  randomState
+ * ----------------------------------------
+ * random vram and registers for a display mode and sprite configuration.
+ * name tables are random, runs of repeated names or a single name (to
+ * exercise the repeated tile paths). sprites are clustered to exercise
+ * the 5th sprite and collision flags
+ */
+static void randomState(VerifyState* state, vrEmuTms9918Mode mode, uint8_t spriteFlags)
+{
+  for (int i = 0; i < TMS_VRAM_16K; ++i)
+  {
+    state->vram[i] = randomByte();
+  }
+
+  for (int reg = 0; reg < TMS_NUM_REGISTERS; ++reg)
+  {
+    state->registers[reg] = randomByte();
+  }
+
+  state->registers[TMS_REG_0] = (uint8_t)((mode == TMS_MODE_GRAPHICS_II ? TMS_R0_MODE_GRAPHICS_II : 0) |
+                                          (state->registers[TMS_REG_0] & TMS_R0_EXT_VDP_ENABLE));
+
+  uint8_t reg1 = TMS_R1_RAM_16K | spriteFlags | (state->registers[TMS_REG_1] & TMS_R1_INT_ENABLE);
+  if (randomByte() & 0x0f)
+  {
+    reg1 |= TMS_R1_DISP_ACTIVE;   /* occasionally blanked */
+  }
+  if (mode == TMS_MODE_TEXT) reg1 |= TMS_R1_MODE_TEXT;
+  if (mode == TMS_MODE_MULTICOLOR) reg1 |= TMS_R1_MODE_MULTICOLOR;
+  state->registers[TMS_REG_1] = reg1;
+
+  /* name table */
+  uint8_t* names = state->vram + ((state->registers[TMS_REG_NAME_TABLE] & 0x0f) << 10);
+  const int numNames = (mode == TMS_MODE_TEXT) ? 960 : 768;
+  switch (randomByte() % 3)
+  {
+    case 0:   /* random */
+      break;
+
+    case 1:   /* runs of up to 64 names, some crossing rows */
+      for (int i = 0; i < numNames;)
+      {
+        const uint8_t name = randomByte();
+        const int run = 1 + (randomByte() & 0x3f);
+        for (int j = 0; j < run && i < numNames; ++j)
+        {
+          names[i++] = name;
+        }
+      }
+      break;
+
+    default:  /* blank screen */
+      memset(names, randomByte(), numNames);
+      break;
+  }
+
+  /* sprite attributes */
+  uint8_t* attr = state->vram + ((state->registers[TMS_REG_SPRITE_ATTR_TABLE] & 0x7f) << 7);
+  const uint8_t clusterY = randomByte() % TMS9918_PIXELS_Y;
+  const int last = (randomByte() & 1) ? randomByte() % 32 : 32;
+  for (int i = 0; i < 32; ++i, attr += 4)
+  {
+    uint8_t y = (randomByte() & 1) ? (uint8_t)(clusterY + (randomByte() & 0x0f)) : randomByte();
+    if (y == 0xd0) ++y;
+    attr[0] = (i == last) ? 0xd0 : y;
+    attr[3] = (uint8_t)((attr[3] & 0x0f) | ((randomByte() & 0x03) ? 0 : 0x80));
+  }
+}
+
+/* Function:  verifyRandom
+ * ----------------------------------------
+ * randomized cases for each mode and sprite configuration
+ */
+static bool verifyRandom(int statesPerCase)
+{
+  static const struct { vrEmuTms9918Mode mode; const char* name; } modes[] = {
+    { TMS_MODE_GRAPHICS_I, "gi" }, { TMS_MODE_GRAPHICS_II, "gii" },
+    { TMS_MODE_TEXT, "text" }, { TMS_MODE_MULTICOLOR, "multicolor" },
+  };
+  static const struct { uint8_t flags; const char* name; } sprites[] = {
+    { TMS_R1_SPRITE_8 | TMS_R1_SPRITE_MAG1, "8x8" }, { TMS_R1_SPRITE_8 | TMS_R1_SPRITE_MAG2, "8x8 mag" },
+    { TMS_R1_SPRITE_16 | TMS_R1_SPRITE_MAG1, "16x16" }, { TMS_R1_SPRITE_16 | TMS_R1_SPRITE_MAG2, "16x16 mag" },
+  };
+
+  bool ok = true;
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m)
+  {
+    for (size_t s = 0; s < sizeof(sprites) / sizeof(sprites[0]); ++s)
+    {
+      char caseName[64];
+      snprintf(caseName, sizeof(caseName), "%s %s", modes[m].name, sprites[s].name);
+
+      VerifyResult result;
+      memset(&result, 0, sizeof(result));
+
+      for (int done = 0; done < statesPerCase; done += MAX_STATES)
+      {
+        const int numStates = (statesPerCase - done < MAX_STATES) ? statesPerCase - done : MAX_STATES;
+        for (int i = 0; i < numStates; ++i)
+        {
+          randomState(&states[i], modes[m].mode, sprites[s].flags);
+        }
+        verifyBatch(caseName, numStates, &result);
+      }
+
+      printResult(caseName, &result);
+      ok &= result.atlasMismatches == 0 && result.deltaMismatches == 0;
+      for (int path = 0; path < NUM_PATHS; ++path)
+      {
+        ok &= result.mismatches[path] == 0;
+      }
+    }
+  }
+  return ok;
+}
+
+/* trace replay context */
+typedef struct
+{
+  VrEmuTms9918* tms9918;
+  const char* name;
+  int numStates;
+  VerifyResult result;
+} TraceVerify;
+
+/* Function:  traceScanLine
+ * ----------------------------------------
+ * capture the state at the end of each replayed frame
+ */
+static void traceScanLine(void* userData, uint8_t y, const uint8_t pixels[TMS9918_PIXELS_X])
+{
+  (void)pixels;
+  TraceVerify* trace = (TraceVerify*)userData;
+  if (y != TMS9918_PIXELS_Y - 1)
+    return;
+
+  VerifyState* state = &states[trace->numStates];
+  for (int reg = 0; reg < TMS_NUM_REGISTERS; ++reg)
+  {
+    state->registers[reg] = vrEmuTms9918RegValue(trace->tms9918, (vrEmuTms9918Register)reg);
+  }
+  vrEmuTms9918ReadVram(trace->tms9918, 0, state->vram, TMS_VRAM_16K);
+
+  if (++trace->numStates == MAX_STATES)
+  {
+    verifyBatch(trace->name, trace->numStates, &trace->result);
+    trace->numStates = 0;
+  }
+}
+
+/* Function:  verifyTrace
+ * ----------------------------------------
+ * recorded states from a trace
+ */
+static bool verifyTrace(const char* filename)
+{
+  VrEmuTms9918TracePlayer* player = vrEmuTms9918TracePlayerNew(filename);
+  if (player == NULL)
+  {
+    fprintf(stderr, "unable to load trace: %s\n", filename);
+    return false;
+  }
+
+  if (vrEmuTms9918TracePlayerVramSize(player) != TMS_VRAM_16K)
+  {
+    fprintf(stderr, "skipping %s: only 16KB traces are supported\n", filename);
+    vrEmuTms9918TracePlayerDestroy(player);
+    return true;
+  }
+
+  const char* name = strrchr(filename, '/');
+  name = name ? name + 1 : filename;
+
+  TraceVerify trace;
+  memset(&trace, 0, sizeof(trace));
+  trace.tms9918 = vrEmuTms9918New();
+  trace.name = name;
+
+  if (!vrEmuTms9918TracePlay(player, trace.tms9918, traceScanLine, &trace, NULL))
+  {
+    fprintf(stderr, "warning: %s is truncated or corrupt. verifying valid portion\n", filename);
+  }
+  if (trace.numStates)
+  {
+    verifyBatch(trace.name, trace.numStates, &trace.result);
+  }
+
+  printResult(name, &trace.result);
+
+  vrEmuTms9918Destroy(trace.tms9918);
+  vrEmuTms9918TracePlayerDestroy(player);
+
+  bool ok = trace.result.atlasMismatches == 0 && trace.result.deltaMismatches == 0;
+  for (int path = 0; path < NUM_PATHS; ++path)
+  {
+    ok &= trace.result.mismatches[path] == 0;
+  }
+  return ok;
+}
+
+/* Function:  parseCount
+ * ----------------------------------------
+ * parse a whole, non-negative decimal argument. returns -1 if it isn't one
+ */
+static int parseCount(const char* arg)
+{
+  char* end = NULL;
+  const long value = strtol(arg, &end, 10);
+  if (end == arg || *end != '\0' || value < 0 || value > 1000000)
+    return -1;
+  return (int)value;
+}
+
+int main(int argc, char* argv[])
+{
+  const int statesPerCase = (argc > 1) ? parseCount(argv[1]) : 64;
+  iterations = (argc > 2) ? parseCount(argv[2]) : 10;
+  if (statesPerCase < 0 || iterations < 1)
+  {
+    fprintf(stderr, "usage: %s [random states per case] [iterations] [trace file ...]\n", argv[0]);
+    return 1;
+  }
+
+  for (int i = 0; i < MAX_STATES; ++i)
+  {
+    instances[i] = vrEmuTms9918New();
+  }
+  layers = vrEmuTms9918LayersNew();
+  atlas = vrEmuTms9918AtlasNew(TMS_ATLAS_TILES, TMS_ATLAS_INDEXED);
+
+  printf("%-24s %6s %10s", "case", "frames", "ref us/f");
+  for (int path = 0; path < NUM_PATHS; ++path)
+  {
+    printf("   %-16s", pathNames[path]);
+  }
+  printf("   %-9s   Delta\n", "Atlas");
+
+  bool ok = verifyRandom(statesPerCase);
+  for (int i = 3; i < argc; ++i)
+  {
+    ok &= verifyTrace(argv[i]);
+  }
+
+  printf("%s\n", ok ? "all paths match the reference" : "MISMATCHES FOUND");
+
+  for (int i = 0; i < MAX_STATES; ++i)
+  {
+    vrEmuTms9918Destroy(instances[i]);
+  }
+  vrEmuTms9918LayersDestroy(layers);
+  vrEmuTms9918AtlasDestroy(atlas);
+
+  return ok ? 0 : 1;
+}